@@ -0,0 +1,296 @@
+//
+// Created by wouter on 17-10-2026.
+//
+// Micro benchmarks of the functions on the hot path of a simulation step, and macro benchmarks of full headless
+// simulation ticks for different boid counts and densities. Results are written as CSV (stdout, or the file given as
+// first argument), one row per benchmark, so runs before and after a change can be compared.
+//
+// Usage: Thesis_benchmark [output.csv] [--quick]
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Application.h"
+#include "BoidSpawners.h"
+#include "Obstacles.h"
+#include "SimulationData.h"
+#include "Simulator.h"
+#include "SpatialGrid.h"
+#include "Terrain.h"
+#include "Utility.h"
+
+namespace {
+    struct BenchmarkResult {
+        std::string kind;           // micro or macro
+        std::string name;
+        std::string parameters;
+        long long iterations;
+        double ns_per_op;
+        double ns_per_boid_tick;    // macro benchmarks only
+    };
+
+    double min_benchmark_seconds = 0.5;
+    int warm_up_ticks = 30;         // macro benchmarks run a fixed amount of ticks, so every run measures the same work
+    int measured_ticks = 300;
+    volatile double sink = 0;       // keeps benchmarked results from being optimised away
+
+    // Runs 'body' (which performs 'ops_per_call' operations) until at least min_benchmark_seconds have passed,
+    // returns the average time per operation in nanoseconds and the amount of operations.
+    std::pair<double, long long> Measure(long long ops_per_call, const std::function<void()> &body) {
+        body(); // warm-up
+        long long calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed{};
+        do {
+            body();
+            calls++;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < min_benchmark_seconds);
+        long long ops = calls * ops_per_call;
+        return {elapsed.count() * 1e9 / static_cast<double>(ops), ops};
+    }
+
+    struct TickMeasurement {
+        double ns_per_tick;
+        double ns_per_boid_tick;
+    };
+
+    // Runs warm_up_ticks unmeasured ticks followed by measured_ticks measured ticks. The time per boid tick is divided
+    // by the boid count of every measured tick, as the population of a simulation can change between ticks.
+    template <typename SimulatorType>
+    TickMeasurement MeasureTicks(SimulatorType &simulation) {
+        for (int i = 0; i < warm_up_ticks; ++i) simulation.Step(sf::seconds(Simulator::FIXED_TIME_STEP));
+        long long boid_ticks = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < measured_ticks; ++i) {
+            boid_ticks += simulation.boids.Size();
+            simulation.Step(sf::seconds(Simulator::FIXED_TIME_STEP));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double ns = elapsed.count() * 1e9;
+        return {ns / measured_ticks, boid_ticks > 0 ? ns / static_cast<double>(boid_ticks) : 0};
+    }
+
+    std::shared_ptr<SimulationConfig> CreateConfig() {
+        auto config = std::make_shared<SimulationConfig>();
+        config->SEED = 1;
+        return config;
+    }
+
+    std::vector<Eigen::Vector2f> CreateRandomPositions(int count, float width, float height) {
+        std::vector<Eigen::Vector2f> positions(count);
+        for (auto& position : positions) {
+            position = {GetRandomFloatBetween(0, width), GetRandomFloatBetween(0, height)};
+        }
+        return positions;
+    }
+
+    // World side length for 'num_boids' boids at 'density' boids per 1000x1000 area
+    float CalcWorldSize(int num_boids, float density) {
+        return 1000.f * std::sqrt(static_cast<float>(num_boids) / density);
+    }
+
+    // --- Micro benchmarks ---
+
+    BenchmarkResult BenchmarkObjRadiusSearch(int num_boids, float density) {
+        auto config = CreateConfig();
+        float size = CalcWorldSize(num_boids, density);
+        SpatialGrid grid(Eigen::Vector2i(size, size), static_cast<int>(config->INTERACTION_RADIUS));
+        grid.Rebuild(CreateRandomPositions(num_boids, size, size));
+
+        std::vector<int> result;
+        auto [ns, ops] = Measure(num_boids, [&] {
+            for (int i = 0; i < num_boids; ++i) {
+                grid.ObjRadiusSearch(config->INTERACTION_RADIUS, i, result);
+                sink = sink + static_cast<double>(result.size());
+            }
+        });
+        return {"micro", "SpatialGrid::ObjRadiusSearch", "boids=" + std::to_string(num_boids) + " density=" + std::to_string(density), ops, ns, 0};
+    }
+
+    BenchmarkResult BenchmarkCalcLanguageDistances(int language_size, int num_neighbours) {
+        auto config = CreateConfig();
+        config->LANGUAGE_SIZE = language_size;
+        EvoBoidStore boids(config, false);
+        for (int i = 0; i < num_neighbours + 1; ++i) {
+            Eigen::VectorXi language_vector(language_size);
+            for (int f = 0; f < language_size; ++f) language_vector[f] = GetRandomIntBetween(0, 1);
+            boids.AddBoid(Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_vector, 1);
+        }
+        std::vector<int> neighbours(num_neighbours);
+        for (int i = 0; i < num_neighbours; ++i) neighbours[i] = i + 1;
+
+        auto [ns, ops] = Measure(num_neighbours, [&] {
+            Eigen::VectorXf distances = boids.CalcLanguageDistances(0, neighbours);
+            sink = sink + distances.sum();
+        });
+        return {"micro", "EvoBoidStore::CalcLanguageDistances", "language_size=" + std::to_string(language_size) + " neighbours=" + std::to_string(num_neighbours), ops, ns, 0};
+    }
+
+    BenchmarkResult BenchmarkGetUpdatedLanguageAndSatisfaction(int num_boids, float density) {
+        auto config = CreateConfig();
+        float size = CalcWorldSize(num_boids, density);
+        CompBoidStore boids(config, false);
+        std::map<int, float> status_map = {{0, 1.f}, {1, 1.f}};
+        for (const auto& position : CreateRandomPositions(num_boids, size, size)) {
+            int index = boids.AddBoid(position, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), GetRandomIntBetween(0, 1));
+            boids.SetLanguageStatusMap(index, &status_map);
+        }
+        SpatialGrid grid(Eigen::Vector2i(size, size), static_cast<int>(config->INTERACTION_RADIUS));
+        grid.Rebuild(boids.pos);
+
+        // Neighbour lists are searched beforehand, only the language update is measured
+        std::vector<std::vector<int>> interacting(num_boids), perceived(num_boids);
+        for (int i = 0; i < num_boids; ++i) {
+            grid.ObjDualRadiusSearch(boids.interaction_radius, boids.perception_radius, i, interacting[i], perceived[i]);
+        }
+
+        auto [ns, ops] = Measure(num_boids, [&] {
+            for (int i = 0; i < num_boids; ++i) {
+                auto [key, satisfaction] = boids.GetUpdatedLanguageAndSatisfaction(i, perceived[i], interacting[i], sf::seconds(1 / 30.f));
+                sink = sink + key + satisfaction;
+            }
+        });
+        return {"micro", "CompBoidStore::GetUpdatedLanguageAndSatisfaction", "boids=" + std::to_string(num_boids) + " density=" + std::to_string(density), ops, ns, 0};
+    }
+
+    BenchmarkResult BenchmarkCalcCollisionNormal() {
+        Eigen::Vector2f start(100, 100), end(900, 700);
+        LineObstacle obstacle(start, end, 10, sf::Color::White);
+        auto positions = CreateRandomPositions(4096, 1000, 1000);
+
+        auto [ns, ops] = Measure(static_cast<long long>(positions.size()), [&] {
+            for (const auto& position : positions) {
+                if (auto normal = obstacle.CalcCollisionNormal(position, 10)) sink = sink + normal->x();
+            }
+        });
+        return {"micro", "LineObstacle::CalcCollisionNormal", "positions=4096", ops, ns, 0};
+    }
+
+    BenchmarkResult BenchmarkIsPointInside(int num_vertices) {
+        // Regular polygon around the world center
+        std::vector<Eigen::Vector2f> vertices;
+        for (int i = 0; i < num_vertices; ++i) {
+            float angle = 2 * static_cast<float>(M_PI) * static_cast<float>(i) / static_cast<float>(num_vertices);
+            vertices.emplace_back(500 + 400 * std::cos(angle), 500 + 400 * std::sin(angle));
+        }
+        Terrain terrain(vertices, 0.1f, {0, 1.f}, 10, 100);
+        auto positions = CreateRandomPositions(4096, 1000, 1000);
+
+        auto [ns, ops] = Measure(static_cast<long long>(positions.size()), [&] {
+            for (const auto& position : positions) {
+                sink = sink + terrain.IsPointInside(position);
+            }
+        });
+        return {"micro", "Terrain::IsPointInside", "vertices=" + std::to_string(num_vertices), ops, ns, 0};
+    }
+
+    // --- Macro benchmarks ---
+
+    BenchmarkResult BenchmarkCompTicks(std::shared_ptr<Context> &context, int num_boids, float density, bool multi_threading) {
+        auto config = CreateConfig();
+        config->MULTI_THREADING = multi_threading;
+        float size = CalcWorldSize(num_boids, density);
+        World world{size, size, {}, {}};
+
+        // Two languages, both spread over the whole world
+        KeySimulationData data(CompSimulation, world, config);
+        data.boid_spawners.push_back(std::make_shared<CompBoidRectangularSpawner>(num_boids / 2, 0, Eigen::Vector2f(0, 0), size, size));
+        data.boid_spawners.push_back(std::make_shared<CompBoidRectangularSpawner>(num_boids - num_boids / 2, 1, Eigen::Vector2f(0, 0), size, size));
+
+        CompSimulator simulation(context, data, "benchmark", 1600, 900);
+        simulation.Init();
+        auto [ns, ns_per_boid] = MeasureTicks(simulation);
+
+        std::string parameters = "boids=" + std::to_string(num_boids) + " density=" + std::to_string(density) +
+                                 " world=" + std::to_string(static_cast<int>(size)) + " threads=" + std::to_string(multi_threading ? context->thread_pool->Size() : 1);
+        return {"macro", "CompSimulator::Step", parameters, measured_ticks, ns, ns_per_boid};
+    }
+
+    BenchmarkResult BenchmarkEvoTicks(std::shared_ptr<Context> &context, int num_boids, float density) {
+        auto config = CreateConfig();
+        float size = CalcWorldSize(num_boids, density);
+        World world{size, size, {}, {}};
+
+        VectorSimulationData data(EvoSimulation, world, config);
+        data.boid_spawners.push_back(std::make_shared<EvoBoidRectangularSpawner>(num_boids, 1, 0.5f, Eigen::Vector2f(0, 0), size, size));
+
+        EvoSimulator simulation(context, data, "benchmark", 1600, 900);
+        simulation.Init();
+        auto [ns, ns_per_boid] = MeasureTicks(simulation);
+
+        std::string parameters = "boids=" + std::to_string(num_boids) + " density=" + std::to_string(density) +
+                                 " world=" + std::to_string(static_cast<int>(size)) + " threads=" + std::to_string(context->thread_pool->Size());
+        return {"macro", "EvoSimulator::Step", parameters, measured_ticks, ns, ns_per_boid};
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string output_file_name;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--quick") quick = true;
+        else output_file_name = argument;
+    }
+    if (quick) {
+        min_benchmark_seconds = 0.1;
+        warm_up_ticks = 5;
+        measured_ticks = 30;
+    }
+
+    // Identical setups on every run
+    SeedThreadRandomGenerator(1);
+    auto context = std::make_shared<Context>(true);
+
+    std::vector<int> boid_counts = quick ? std::vector<int>{1000} : std::vector<int>{1000, 4000, 10000};
+    std::vector<float> densities = quick ? std::vector<float>{100} : std::vector<float>{25, 100, 400};
+
+    std::vector<BenchmarkResult> results;
+    auto Run = [&](BenchmarkResult result) {
+        std::cerr << result.name << " (" << result.parameters << "): " << result.ns_per_op << " ns/op" << std::endl;
+        results.push_back(std::move(result));
+    };
+
+    for (float density : densities) {
+        Run(BenchmarkObjRadiusSearch(boid_counts.back(), density));
+        Run(BenchmarkGetUpdatedLanguageAndSatisfaction(boid_counts.back(), density));
+    }
+    for (int language_size : {10, 50, 200}) {
+        Run(BenchmarkCalcLanguageDistances(language_size, 100));
+    }
+    Run(BenchmarkCalcCollisionNormal());
+    for (int vertices : {4, 16, 64}) {
+        Run(BenchmarkIsPointInside(vertices));
+    }
+
+    for (int num_boids : boid_counts) {
+        for (float density : densities) {
+            Run(BenchmarkCompTicks(context, num_boids, density, false));
+            Run(BenchmarkCompTicks(context, num_boids, density, true));
+            Run(BenchmarkEvoTicks(context, num_boids, density));
+        }
+    }
+
+    std::ofstream output_file;
+    if (!output_file_name.empty()) {
+        output_file.open(output_file_name);
+        if (!output_file.is_open()) {
+            std::cerr << "ERROR: cannot open file " << output_file_name << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out = output_file.is_open() ? output_file : std::cout;
+    out << "kind,name,parameters,iterations,ns_per_op,ns_per_boid_tick\n";
+    for (const auto& result : results) {
+        out << result.kind << ',' << result.name << ',' << result.parameters << ',' << result.iterations << ','
+            << result.ns_per_op << ',' << result.ns_per_boid_tick << '\n';
+    }
+    return EXIT_SUCCESS;
+}
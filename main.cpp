@@ -1,9 +1,36 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <string>
 
 #include "Application.h"
+#include "HeadlessRunner.h"
+#include "SweepRunner.h"
 #include "src/Serialization.h"
 
-int main() {
+int main(int argc, char* argv[]) {
+
+    // Headless mode: Thesis_run --headless <scenario file> [simulated seconds] [checkpoint to resume from]
+    if (argc >= 3 && std::string(argv[1]) == "--headless") {
+        float run_time = 0.f;
+        if (argc >= 4) {
+            const char* end = argv[3] + std::strlen(argv[3]);
+            auto [ptr, error] = std::from_chars(argv[3], end, run_time);
+            if (error != std::errc() || ptr != end || !std::isfinite(run_time) || run_time < 0) {
+                std::cerr << "Usage: Thesis_run --headless <scenario file> [simulated seconds >= 0] [checkpoint to resume from]" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        HeadlessRunner runner(argv[2], run_time, argc >= 5 ? argv[4] : "");
+        return runner.Run();
+    }
+
+    // Parameter sweep: Thesis_run --sweep <scenario file> <sweep file>
+    if (argc >= 4 && std::string(argv[1]) == "--sweep") {
+        SweepRunner runner(argv[2], argv[3]);
+        return runner.Run();
+    }
 
     Application application;
     application.Run();
@@ -5,19 +5,28 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
+#include <algorithm>
 #include <memory>
+#include <thread>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include "StateManager.h"
+#include "ThreadPool.h"
 
 class StateManager;
 
 struct Context {
     std::unique_ptr<StateManager> state_manager;
-    std::unique_ptr<sf::RenderWindow> window;
+    std::unique_ptr<sf::RenderWindow> window;   // nullptr when headless
+    std::unique_ptr<ThreadPool> thread_pool;
+    bool headless;
 
-    Context() {
+    // A headless context has no window, and simulators created with it skip all textures and sprites.
+    // 'num_threads' = 0 uses every hardware thread.
+    explicit Context(bool headless = false, size_t num_threads = 0) : headless(headless) {
         state_manager = std::make_unique<StateManager>();
-        window = std::make_unique<sf::RenderWindow>();
+        if (!headless) window = std::make_unique<sf::RenderWindow>();
+        if (num_threads == 0) num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        thread_pool = std::make_unique<ThreadPool>(num_threads);
     }
 };
 
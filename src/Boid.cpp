@@ -11,126 +11,194 @@
 #include "Obstacles.h"
 #include "ResourceManager.h"
 
-Boid::Boid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig>& config,
-           float perception_radius, float interaction_radius, float avoidance_radius, float collision_radius)
-    : pos(std::move(pos)), vel(std::move(vel)), acc(std::move(acc)),
-      perception_radius(perception_radius), interaction_radius(interaction_radius),
-      separation_radius(avoidance_radius), collision_radius(collision_radius) {
+BoidStore::BoidStore(const std::shared_ptr<SimulationConfig>& config, bool has_sprites)
+    : config(config), has_sprites(has_sprites),
+      perception_radius(config->PERCEPTION_RADIUS), interaction_radius(config->INTERACTION_RADIUS),
+      separation_radius(config->SEPARATION_RADIUS), collision_radius(config->BOID_COLLISION_RADIUS) {
+}
 
-    max_speed = config->MAX_SPEED;
-    min_speed = config->MIN_SPEED;
-    spatial_key = -1;
+int BoidStore::AddBoid(Eigen::Vector2f position, Eigen::Vector2f velocity, Eigen::Vector2f acceleration, sf::Color color) {
+    int index = Size();
+    pos.push_back(std::move(position));
+    vel.push_back(std::move(velocity));
+    acc.push_back(std::move(acceleration));
+    max_speed.push_back(config->MAX_SPEED);
+    min_speed.push_back(config->MIN_SPEED);
+
+    if (has_sprites) {
+        sf::Sprite sprite;
+        if (const auto& p_texture = ResourceManager::GetTexture("boid")) {
+            sprite.setTexture(*p_texture);
+            sprite.setOrigin(p_texture->getSize().x/2.0f, p_texture->getSize().y/2.0f);
+        }
+        sprite.setPosition(pos[index].x(), pos[index].y());
+        sprite.setColor(color);
+        sprites.push_back(sprite);
+    }
 
-    const auto& p_texture = ResourceManager::GetTexture("boid");
-    sprite.setTexture(*p_texture);
-    sprite.setOrigin(p_texture->getSize().x/2.0f, p_texture->getSize().y/2.0f);
-    sprite.setPosition(this->pos.x(), this->pos.y());
-    sprite.setColor(sf::Color(255, 0, 0));
+    // Hand out a handle, reusing a freed slot if there is one
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slot_indices.size());
+        slot_indices.push_back(-1);
+        slot_generations.push_back(0);
+    }
+    slot_indices[slot] = index;
+    index_slots.push_back(slot);
 
+    return index;
 }
 
-Boid::Boid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig>& config)
-    : pos(std::move(pos)), vel(std::move(vel)), acc(std::move(acc)), config(config),
-      perception_radius(config->PERCEPTION_RADIUS), interaction_radius(config->INTERACTION_RADIUS),
-      separation_radius(config->SEPARATION_RADIUS), collision_radius(config->BOID_COLLISION_RADIUS) {
+void BoidStore::RemoveBoid(int index) {
+    // Invalidate the handle of the removed boid
+    uint32_t slot = index_slots[index];
+    slot_indices[slot] = -1;
+    slot_generations[slot]++;
+    free_slots.push_back(slot);
+
+    // The last boid takes over the removed index
+    int last_index = Size() - 1;
+    if (index != last_index) {
+        slot_indices[index_slots[last_index]] = index;
+    }
+    SwapRemove(index_slots, index);
+    SwapRemove(pos, index);
+    SwapRemove(vel, index);
+    SwapRemove(acc, index);
+    SwapRemove(min_speed, index);
+    SwapRemove(max_speed, index);
+    if (has_sprites) SwapRemove(sprites, index);
+}
+
+void BoidStore::RemoveAllBoids() {
+    while (Size() > 0) {
+        RemoveBoid(Size() - 1);
+    }
+}
 
-    max_speed = config->MAX_SPEED;
-    min_speed = config->MIN_SPEED;
-    spatial_key = -1;
+int BoidStore::Size() const {
+    return static_cast<int>(pos.size());
+}
 
-    const auto& p_texture = ResourceManager::GetTexture("boid");
-    sprite.setTexture(*p_texture);
-    sprite.setOrigin(p_texture->getSize().x/2.0f, p_texture->getSize().y/2.0f);
-    sprite.setPosition(this->pos.x(), this->pos.y());
-    sprite.setColor(sf::Color::Yellow);
+BoidHandle BoidStore::GetHandle(int index) const {
+    uint32_t slot = index_slots[index];
+    return {slot, slot_generations[slot]};
+}
 
+int BoidStore::GetIndex(BoidHandle handle) const {
+    if (handle.slot >= slot_indices.size() || slot_generations[handle.slot] != handle.generation) {
+        return -1;
+    }
+    return slot_indices[handle.slot];
 }
 
 
-Eigen::Vector2f Boid::AvoidBorders(float width, float height) const {
+Eigen::Vector2f BoidStore::AvoidBorders(int index, float width, float height) const {
     constexpr int buffer_zone = 300;
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
-    if (pos.x() < buffer_zone) {
+    if (pos[index].x() < buffer_zone) {
         acceleration.x() += config->MAX_SPEED*2;
     }
-    if (pos.x() > width - buffer_zone) {
+    if (pos[index].x() > width - buffer_zone) {
         acceleration.x() -= config->MAX_SPEED*2;
     }
-    if (pos.y() < buffer_zone) {
+    if (pos[index].y() < buffer_zone) {
         acceleration.y() += config->MAX_SPEED*2;
     }
-    if (pos.y() > height - buffer_zone) {
+    if (pos[index].y() > height - buffer_zone) {
         acceleration.y() -= config->MAX_SPEED*2;
     }
     return acceleration;
 }
 
+Eigen::Vector2f BoidStore::CalcSeparationAcceleration(int index, const std::vector<int>& interacting_boids) const {
 
-void Boid::UpdateVelocity(const std::vector<std::shared_ptr<Obstacle>> &obstacles, const sf::Time &delta_time) {
+    Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
+    float squared_separation_radius = separation_radius * separation_radius;
+
+    for (int other : interacting_boids) {
+        Eigen::Vector2f pos_difference = pos[other] - pos[index];
+        float squared_distance = pos_difference.squaredNorm();
+        if (squared_distance <= squared_separation_radius) {
+            float strength = std::pow((squared_separation_radius - squared_distance) / squared_separation_radius, 2);
+            acceleration -= pos_difference.normalized() * max_speed[index] * config->SEPARATION_FACTOR * (strength);
+        }
+    }
+
+    return acceleration;
+}
+
+
+void BoidStore::UpdateVelocity(int index, const std::vector<std::shared_ptr<Obstacle>> &obstacles, const sf::Time &delta_time) {
 
     // Handle collisions
     Eigen::Vector2f collision_normal = Eigen::Vector2f::Zero();
     for(auto& obstacle : obstacles) {
-        auto normal = obstacle->CalcCollisionNormal(this->pos, this->collision_radius);
+        auto normal = obstacle->CalcCollisionNormal(pos[index], collision_radius);
         if (normal) {
-            collision_normal += *obstacle->CalcCollisionNormal(this->pos, this->collision_radius);
+            collision_normal += *normal;
         }
     }
     if (!collision_normal.isApprox(Eigen::Vector2f::Zero())) {
-        float velocity_along_normal = vel.dot(collision_normal);
+        float velocity_along_normal = vel[index].dot(collision_normal);
 
         // If the boid is moving away from the collision, do nothing
         if (velocity_along_normal >= 0) {
-            SetVelocity(vel + acc * delta_time.asSeconds());
+            SetVelocity(index, vel[index] + acc[index] * delta_time.asSeconds());
         } else {
             float impulse_magnitude = -(1 + config->RESTITUTION_COEFFICIENT) * velocity_along_normal;
             Eigen::Vector2f impulse = collision_normal * impulse_magnitude;
-            SetVelocity(vel + impulse);
+            SetVelocity(index, vel[index] + impulse);
         }
     } else {
-        SetVelocity(vel + acc * delta_time.asSeconds());
+        SetVelocity(index, vel[index] + acc[index] * delta_time.asSeconds());
     }
 }
 
-void Boid::SetMinMaxSpeed(float min, float max) {
-    this->max_speed = max;
-    this->min_speed = min;
+void BoidStore::SetMinMaxSpeed(int index, float min, float max) {
+    max_speed[index] = max;
+    min_speed[index] = min;
 }
 
-void Boid::SetDefaultMinMaxSpeed() {
-    this->max_speed = config->MAX_SPEED;
-    this->min_speed = config->MIN_SPEED;
+void BoidStore::SetDefaultMinMaxSpeed(int index) {
+    max_speed[index] = config->MAX_SPEED;
+    min_speed[index] = config->MIN_SPEED;
 }
 
-void Boid::UpdatePosition(const sf::Time &delta_time) {
-    SetPosition(pos + vel * delta_time.asSeconds());
+void BoidStore::UpdatePosition(int index, const sf::Time &delta_time) {
+    SetPosition(index, pos[index] + vel[index] * delta_time.asSeconds());
 }
 
-void Boid::UpdateSprite() {
-    sprite.setPosition(pos.x(), pos.y());
-    auto angle = static_cast<float>(std::atan2(vel.y(), vel.x()) * 180 / std::numbers::pi);
-    sprite.setRotation(angle);
+void BoidStore::UpdateSprite(int index) {
+    if (!has_sprites) return;
+    sprites[index].setPosition(pos[index].x(), pos[index].y());
+    auto angle = static_cast<float>(std::atan2(vel[index].y(), vel[index].x()) * 180 / std::numbers::pi);
+    sprites[index].setRotation(angle);
 }
 
-void Boid::SetPosition(Eigen::Vector2f position) {
-    pos = std::move(position);
+void BoidStore::UpdateSprites() {
+    for (int i = 0; i < Size(); ++i) {
+        UpdateSprite(i);
+    }
+}
+
+void BoidStore::SetPosition(int index, Eigen::Vector2f position) {
+    pos[index] = std::move(position);
 }
 
-void Boid::SetVelocity(Eigen::Vector2f velocity) {
-    if (velocity.norm() > max_speed) {
-        velocity = velocity.normalized() * max_speed;
+void BoidStore::SetVelocity(int index, Eigen::Vector2f velocity) {
+    if (velocity.norm() > max_speed[index]) {
+        velocity = velocity.normalized() * max_speed[index];
     }
-    else if (velocity.norm() < min_speed) {
-        velocity = velocity.normalized() * min_speed;
+    else if (velocity.norm() < min_speed[index]) {
+        velocity = velocity.normalized() * min_speed[index];
     }
-    vel = std::move(velocity);
+    vel[index] = std::move(velocity);
 }
 
-void Boid::SetAcceleration(Eigen::Vector2f acceleration) {
-    acc = std::move(acceleration);
+void BoidStore::SetAcceleration(int index, Eigen::Vector2f acceleration) {
+    acc[index] = std::move(acceleration);
 }
-
-
-
-
-
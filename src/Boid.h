@@ -5,156 +5,202 @@
 #ifndef THESIS_BOID_H
 #define THESIS_BOID_H
 
+#include <cstdint>
 #include <future>
+#include <map>
 #include <memory>
 #include <set>
+#include <span>
+#include <vector>
 
 #include <Eigen/Dense>
 #include <SFML/Graphics.hpp>
 
 #include "Obstacles.h"
 #include "LanguageManager.h"
+#include "LanguageTable.h"
 #include "SimulationConfig.h"
 
 struct World;
+class FeatureCountGrid;
 
-class Boid {
-private:
-    std::shared_ptr<sf::Texture> p_texture;
-
-public:
-
-    Boid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
-         const std::shared_ptr<SimulationConfig>& config,
-         float perception_radius,
-         float interaction_radius,
-         float separation_radius,
-         float collision_radius);
+// Stable reference to a boid. A boid's index changes when other boids are removed, its handle does not.
+struct BoidHandle {
+    uint32_t slot;
+    uint32_t generation;
 
-    Boid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
-         const std::shared_ptr<SimulationConfig>& config);
-
-    virtual ~Boid() = default;
+    bool operator==(const BoidHandle& other) const = default;
+};
 
-    sf::Sprite sprite;
+// Structure-of-arrays boid storage: every per-boid field is kept in its own contiguous array, indexed by the
+// boid's index (0 .. Size()-1). Removing a boid moves the last boid into the freed index.
+class BoidStore {
+public:
 
-    Eigen::Vector2f pos;
-    Eigen::Vector2f vel;
-    Eigen::Vector2f acc;
+    // Without sprites (headless runs) the sprites array stays empty and sprite updates are skipped.
+    explicit BoidStore(const std::shared_ptr<SimulationConfig>& config, bool has_sprites = true);
+    virtual ~BoidStore() = default;
 
     std::shared_ptr<SimulationConfig> config;
+    const bool has_sprites;
     float perception_radius;
     float interaction_radius;
     float separation_radius;
     float collision_radius;
-    float min_speed;
-    float max_speed;
-
-    int spatial_key;
 
-    void UpdateSprite();
-    void SetPosition(Eigen::Vector2f position);
-    void SetVelocity(Eigen::Vector2f velocity);
-    void SetAcceleration(Eigen::Vector2f acceleration);
-    void SetMinMaxSpeed(float min, float max);
-    void SetDefaultMinMaxSpeed();
-
-    void UpdatePosition(const sf::Time &delta_time);
-    void UpdateVelocity(const std::vector<std::shared_ptr<Obstacle>> &obstacles, const sf::Time &delta_time);
-    Eigen::Vector2f AvoidBorders(float width, float height) const;
+    std::vector<Eigen::Vector2f> pos;
+    std::vector<Eigen::Vector2f> vel;
+    std::vector<Eigen::Vector2f> acc;
+    std::vector<float> min_speed;
+    std::vector<float> max_speed;
+    std::vector<sf::Sprite> sprites;
+
+    int Size() const;
+    BoidHandle GetHandle(int index) const;
+    int GetIndex(BoidHandle handle) const; // -1 if the boid no longer exists
+    virtual void RemoveBoid(int index);
+    void RemoveAllBoids();
+
+    void UpdateSprite(int index);
+    void UpdateSprites();
+    void SetPosition(int index, Eigen::Vector2f position);
+    void SetVelocity(int index, Eigen::Vector2f velocity);
+    void SetAcceleration(int index, Eigen::Vector2f acceleration);
+    void SetMinMaxSpeed(int index, float min, float max);
+    void SetDefaultMinMaxSpeed(int index);
+
+    void UpdatePosition(int index, const sf::Time &delta_time);
+    void UpdateVelocity(int index, const std::vector<std::shared_ptr<Obstacle>> &obstacles, const sf::Time &delta_time);
+    Eigen::Vector2f AvoidBorders(int index, float width, float height) const;
+    Eigen::Vector2f CalcSeparationAcceleration(int index, const std::vector<int> &interacting_boids) const;
+
+protected:
+    int AddBoid(Eigen::Vector2f position, Eigen::Vector2f velocity, Eigen::Vector2f acceleration, sf::Color color);
+
+    // Remove an element the same way boids are removed: by moving the last element into its place.
+    template<typename T>
+    static void SwapRemove(std::vector<T>& column, int index) {
+        if (index != static_cast<int>(column.size()) - 1) {
+            column[index] = std::move(column.back());
+        }
+        column.pop_back();
+    }
 
+private:
+    std::vector<uint32_t> index_slots;          // slot of each boid, indexed by boid index
+    std::vector<int> slot_indices;              // boid index stored in each slot (-1 if the slot is free)
+    std::vector<uint32_t> slot_generations;     // incremented every time a slot is freed
+    std::vector<uint32_t> free_slots;
 };
 
 
-class CompBoid : public Boid {
+class CompBoidStore : public BoidStore {
 public:
-    int language_key;
-    float language_satisfaction;
-    int updated_language_key = -1;
-    std::shared_ptr<std::map<int, float>> language_status_map;
-
-    CompBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
-            const std::shared_ptr<SimulationConfig> &config,
-            int language_key,
-            float perception_radius,
-            float interaction_radius,
-            float separation_radius,
-            float collision_radius);
-
-    CompBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-            int language_key);
+    std::vector<int> language_key;
+    std::vector<float> language_satisfaction;
+    std::vector<int> updated_language_key;
+    std::vector<const std::map<int, float>*> language_status_map;
+
+    explicit CompBoidStore(const std::shared_ptr<SimulationConfig>& config, bool has_sprites = true);
+
+    int AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, int language_key);
+    void RemoveBoid(int index) override;
 
     // No write functions for multi threading.
-    std::pair<int, float> GetUpdatedLanguageAndSatisfaction(const std::vector<CompBoid *> &perceived_boids,
-                                                            const std::vector<CompBoid *> &interacting_boids,
+    std::pair<int, float> GetUpdatedLanguageAndSatisfaction(int index,
+                                                            const std::vector<int> &perceived_boids,
+                                                            const std::vector<int> &interacting_boids,
                                                             sf::Time delta_time) const;
-    Eigen::Vector2f GetUpdatedAcceleration(const std::vector<CompBoid *> &interacting_boids) const;
+    Eigen::Vector2f GetUpdatedAcceleration(int index, const std::vector<int> &interacting_boids) const;
 
     // Single thread functions
-    void UpdateAcceleration(const std::vector<CompBoid *> &interacting_boids);
-    Eigen::Vector2f CalcCoherenceAlignmentAcceleration(const std::vector<CompBoid*> &nearby_boids) const;
-    Eigen::Vector2f CalcSeparationAcceleration(const std::vector<CompBoid*>& interacting_boids) const;
-    Eigen::Vector2f CalcAvoidanceAcceleration(const std::vector<CompBoid*>& nearby_boids) const;
-    void UpdateLanguageSatisfaction(const std::vector<CompBoid *> &perceived_boids,
-                                  const std::vector<CompBoid *> &interacting_boids,
-                                  sf::Time delta_time);
+    void UpdateAcceleration(int index, const std::vector<int> &interacting_boids);
+    Eigen::Vector2f CalcCoherenceAlignmentAcceleration(int index, const std::vector<int> &nearby_boids) const;
+    Eigen::Vector2f CalcAvoidanceAcceleration(int index, const std::vector<int> &nearby_boids) const;
+    void UpdateLanguageSatisfaction(int index,
+                                    const std::vector<int> &perceived_boids,
+                                    const std::vector<int> &interacting_boids,
+                                    sf::Time delta_time);
 
-    void UpdateColor();
-    void UpdateLanguage();
+    void UpdateColor(int index);
+    void UpdateLanguage(int index);
 
-    void SetLanguageKey(int key);
-    void SetLanguageSatisfaction(float value);
+    void SetLanguageKey(int index, int key);
+    void SetLanguageSatisfaction(int index, float value);
 
-    void SetLanguageStatusMap(const std::shared_ptr<std::map<int, float>> &language_status_map);
+    void SetLanguageStatusMap(int index, const std::map<int, float> *language_status_map);
 };
 
 
-class EvoBoid : public Boid {
+class EvoBoidStore : public BoidStore {
 public:
-    Eigen::VectorXi language_vector;
-    float language_influence;
-    float age = 0;
-
-    EvoBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-            Eigen::VectorXi language_vector, float language_influence,
-            float perception_radius,
-            float interaction_radius,
-            float separation_radius,
-            float collision_radius);
-
-    EvoBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-               Eigen::VectorXi language_vector, float language_influence);
-
-    Eigen::VectorXf CalcLanguageDistances(const std::vector<EvoBoid*> &boids) const;
-    Eigen::VectorXf CalcLanguageDistances(const std::vector<std::shared_ptr<EvoBoid>> &boids) const;
+    // Id of each boid's language in the language table. The language vectors themselves are stored bit-packed, change
+    // them through SetLanguageVector or SwitchLanguageFeatures so the ids and the table stay up to date.
+    std::vector<int> language_id;
+    std::vector<float> language_influence;
+    std::vector<float> age;
+
+    explicit EvoBoidStore(const std::shared_ptr<SimulationConfig>& config, bool has_sprites = true);
+
+    int AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
+                Eigen::VectorXi language_vector, float language_influence);
+    // Same, with the language vector already packed ('language_words' words, bit f is feature f)
+    int AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
+                std::span<const uint64_t> packed_language, float language_influence);
+    void RemoveBoid(int index) override;
+
+    void SetLanguageVector(int index, const Eigen::VectorXi &language_vector);
+    Eigen::VectorXi GetLanguageVector(int index) const;
+    bool GetLanguageFeature(int index, int feature_index) const;
+    std::span<const uint64_t> GetLanguageWords(int index) const; // packed language vector, bit f is feature f
+    std::span<const uint64_t> GetLanguageWords() const;          // packed language vectors of all boids, in index order
+    const LanguageTable& GetLanguageTable() const;
+    int CalcLanguageDifference(int index, int other_index) const; // number of differing features
+
+    Eigen::VectorXf CalcLanguageDistances(int index, const std::vector<int> &boids) const;
+    Eigen::VectorXf CalcLanguageDistances(int index) const;
     float CalcBehaviourModifier(float language_distance) const;
 
     // Acceleration
-    void UpdateAcceleration(const std::vector<EvoBoid *> &interacting_boids, const Eigen::VectorXf &language_distances);
-    Eigen::Vector2f GetUpdatedAcceleration(const std::vector<EvoBoid *> &interacting_boids, const Eigen::VectorXf &language_distances) const;
-    Eigen::Vector2f CalcAvoidanceAcceleration(const std::vector<EvoBoid*>& interacting_boids, Eigen::VectorXf language_distances) const;
-    Eigen::Vector2f CalcSeparationAcceleration(const std::vector<EvoBoid*>& interacting_boids) const;
-    Eigen::Vector2f CalcCoherenceAlignmentAcceleration(const std::vector<EvoBoid*>& interacting_boids, const Eigen::VectorXf& language_similarities) const;
+    void UpdateAcceleration(int index, const std::vector<int> &interacting_boids, const Eigen::VectorXf &language_distances);
+    Eigen::Vector2f GetUpdatedAcceleration(int index, const std::vector<int> &interacting_boids, const Eigen::VectorXf &language_distances) const;
+    Eigen::Vector2f CalcAvoidanceAcceleration(int index, const std::vector<int> &interacting_boids, const Eigen::VectorXf &language_distances) const;
+    Eigen::Vector2f CalcCoherenceAlignmentAcceleration(int index, const std::vector<int> &interacting_boids, const Eigen::VectorXf &language_similarities) const;
 
     // Language
-    void UpdateLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids,
-                                const Eigen::VectorXf& language_distances,
-                                const std::vector<EvoBoid *> &perceived_boids,
+    // Feature variants of the perceived boids are counted with 'feature_counts' (rebuilt for the current step)
+    void UpdateLanguageFeatures(int index,
+                                const std::vector<int> &interacting_boids,
+                                const Eigen::VectorXf &language_distances,
+                                const FeatureCountGrid &feature_counts,
                                 sf::Time delta_time);
-    std::set<int> GetUpdatedLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids,
-                                         const Eigen::VectorXf &language_distances,
-                                         const std::vector<EvoBoid*> &perceived_boids,
-                                         sf::Time delta_time);
-    void SwitchLanguageFeatures(const std::set<int> & features);
+    std::set<int> GetUpdatedLanguageFeatures(int index,
+                                             const std::vector<int> &interacting_boids,
+                                             const Eigen::VectorXf &language_distances,
+                                             const FeatureCountGrid &feature_counts,
+                                             sf::Time delta_time) const;
+    void SwitchLanguageFeatures(int index, const std::set<int> &features);
     int CalcMutatedLanguageFeature(sf::Time delta_time) const;
-    std::set<int> CalcAdoptedLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids, const Eigen::VectorXf &language_distances, const std::vector<
-                                              EvoBoid *> &perceived_boids, sf::Time delta_time);
+    std::set<int> CalcAdoptedLanguageFeatures(int index,
+                                              const std::vector<int> &interacting_boids,
+                                              const Eigen::VectorXf &language_distances,
+                                              const FeatureCountGrid &feature_counts,
+                                              sf::Time delta_time) const;
 
     // Population dynamics
-    void UpdateAge(sf::Time delta_time);
-    Eigen::VectorXi GetMostCommonLanguage(const std::vector<EvoBoid *> &boids) const;
+    void UpdateAge(int index, sf::Time delta_time);
+    Eigen::VectorXi GetMostCommonLanguage(int index, const std::vector<int> &boids) const;
+
+    Eigen::Vector2f GetOffspringPos(int index, const World& world) const;
+
+private:
+    // Packed language vectors: 'language_words' 64-bit words per boid, boid i starts at i * language_words.
+    // Distances are the popcount of the XOR of two boids' words.
+    int language_words;
+    std::vector<uint64_t> language_bits;
+    LanguageTable language_table;
 
-    Eigen::Vector2f GetOffspringPos(const World& world);
+    void PackLanguageVector(int index, const Eigen::VectorXi &language_vector);
 };
 
-#endif //THESIS_BOID_H
\ No newline at end of file
+#endif //THESIS_BOID_H
@@ -62,10 +62,11 @@ CompBoidSpawner::CompBoidSpawner(int boids_spawned, int language_key) : boids_sp
 
 void CompBoidSpawner::SetTextString() {
     sf::Color color = LanguageManager::GetLanguageColor(language_key);
-    sf::Font& font = *ResourceManager::GetFont("arial");
     text.setString(std::to_string(boids_spawned));
     text.setFillColor(color);
-    text.setFont(font);
+    if (const auto& p_font = ResourceManager::GetFont("arial")) {
+        text.setFont(*p_font);
+    }
 }
 
 CompBoidCircularSpawner::CompBoidCircularSpawner(int boids_spawned, int language_key, Eigen::Vector2f center_pos, float radius)
@@ -85,11 +86,10 @@ CompBoidCircularSpawner::CompBoidCircularSpawner(int boids_spawned, int language
     circle.setFillColor(color);
 }
 
-void CompBoidCircularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, std::vector<std::shared_ptr<CompBoid>>& boids) {
+void CompBoidCircularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, CompBoidStore& boids) {
     for (int i = 0; i < boids_spawned; ++i) {
         auto spawn_point = CalcRandomPointInSpawnZone(world, config->BOID_COLLISION_RADIUS);
-        auto new_boid = std::make_shared<CompBoid>(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), config, language_key);
-        boids.emplace_back(std::move(new_boid));
+        boids.AddBoid(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_key);
     }
 }
 
@@ -153,11 +153,10 @@ CompBoidRectangularSpawner::CompBoidRectangularSpawner(int boids_spawned, int la
     rect.setFillColor(color);
 }
 
-void CompBoidRectangularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, std::vector<std::shared_ptr<CompBoid>>& boids) {
+void CompBoidRectangularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, CompBoidStore& boids) {
     for (int i = 0; i < boids_spawned; ++i) {
         auto spawn_point = CalcRandomPointInSpawnZone(world, config->BOID_COLLISION_RADIUS);
-        auto new_boid = std::make_shared<CompBoid>(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), config, language_key);
-        boids.emplace_back(std::move(new_boid));
+        boids.AddBoid(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_key);
     }
 }
 
@@ -209,11 +208,12 @@ EvoBoidSpawner::EvoBoidSpawner(int boids_spawned, int vector_seed, float feature
 
 void EvoBoidSpawner::SetTextString() {
     sf::Color color = sf::Color::White;
-    sf::Font& font = *ResourceManager::GetFont("arial");
     auto text_str = "\n boids: " + std::to_string(boids_spawned) + "\n seed: " + std::to_string(vector_seed) + "\n bias: " + std::to_string(feature_bias).substr(0,3);
     text.setString(text_str);
     text.setFillColor(color);
-    text.setFont(font);
+    if (const auto& p_font = ResourceManager::GetFont("arial")) {
+        text.setFont(*p_font);
+    }
 }
 
 EvoBoidCircularSpawner::EvoBoidCircularSpawner(int boids_spawned, int vector_seed, float feature_bias, Eigen::Vector2f center_pos, float radius)
@@ -245,14 +245,12 @@ Eigen::VectorXi EvoBoidSpawner::GetRandomLanguageVector(const std::shared_ptr<Si
 }
 
 void EvoBoidCircularSpawner::AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config,
-                                         std::vector<std::shared_ptr<EvoBoid>> &boids) {
+                                         EvoBoidStore &boids) {
 
     Eigen::VectorXi language_vector = GetRandomLanguageVector(config);
     for (int i = 0; i < boids_spawned; ++i) {
         auto spawn_point = CalcRandomPointInSpawnZone(world, config->BOID_COLLISION_RADIUS);
-        auto new_boid = std::make_shared<EvoBoid>(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), config,
-                                                     language_vector, 1);
-        boids.emplace_back(std::move(new_boid));
+        boids.AddBoid(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_vector, 1);
     }
 }
 
@@ -312,14 +310,12 @@ EvoBoidRectangularSpawner::EvoBoidRectangularSpawner(int boids_spawned, int vect
     rect.setFillColor(color);
 }
 
-void EvoBoidRectangularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, std::vector<std::shared_ptr<EvoBoid>>& boids) {
+void EvoBoidRectangularSpawner::AddBoids(const World& world, const std::shared_ptr<SimulationConfig>& config, EvoBoidStore& boids) {
 
     Eigen::VectorXi language_vector = GetRandomLanguageVector(config);
     for (int i = 0; i < boids_spawned; ++i) {
         auto spawn_point = CalcRandomPointInSpawnZone(world, config->BOID_COLLISION_RADIUS);
-        auto new_boid = std::make_shared<EvoBoid>(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), config,
-                                                     language_vector, 1);
-        boids.emplace_back(std::move(new_boid));
+        boids.AddBoid(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_vector, 1);
     }
 }
 
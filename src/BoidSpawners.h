@@ -56,7 +56,7 @@ public:
     sf::Text text;
 
     CompBoidSpawner(int boids_spawned, int language_key);
-    virtual void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<CompBoid>> &boids) {};
+    virtual void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, CompBoidStore &boids) {};
 
     void SetTextString();
 };
@@ -66,7 +66,7 @@ class CompBoidCircularSpawner : public CompBoidSpawner, public CircularSpawner {
 public:
 
     CompBoidCircularSpawner(int boids_spawned, int language_key, Eigen::Vector2f center_pos, float radius);
-    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<CompBoid>> &boids) override;
+    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, CompBoidStore &boids) override;
     void Draw(sf::RenderWindow* window) const override;
     bool IsInside(Eigen::Vector2f pos, float radius) override;
 
@@ -78,7 +78,7 @@ public:
 class CompBoidRectangularSpawner : public CompBoidSpawner, public RectangularSpawner {
 public:
     CompBoidRectangularSpawner(int boids_spawned, int language_key, Eigen::Vector2f pos, float width, float height);
-    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<CompBoid>> &boids) override;
+    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, CompBoidStore &boids) override;
     void Draw(sf::RenderWindow* window) const override;
     bool IsInside(Eigen::Vector2f pos, float radius) override;
 
@@ -98,7 +98,7 @@ public:
 
     EvoBoidSpawner(int boids_spawned, int vector_seed, float feature_bias);
     Eigen::VectorXi GetRandomLanguageVector(const std::shared_ptr<SimulationConfig> &config) const;
-    virtual void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<EvoBoid>> &boids) {};
+    virtual void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, EvoBoidStore &boids) {};
 
     void SetTextString();
 
@@ -108,7 +108,7 @@ class EvoBoidCircularSpawner : public EvoBoidSpawner, public CircularSpawner {
 public:
 
     EvoBoidCircularSpawner(int boids_spawned, int vector_seed, float feature_bias, Eigen::Vector2f center_pos, float radius);
-    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<EvoBoid>> &boids) override;
+    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, EvoBoidStore &boids) override;
     void Draw(sf::RenderWindow* window) const override;
     bool IsInside(Eigen::Vector2f pos, float radius) override;
 
@@ -121,7 +121,7 @@ class EvoBoidRectangularSpawner : public EvoBoidSpawner, public RectangularSpawn
 public:
 
     EvoBoidRectangularSpawner(int boids_spawned, int vector_seed, float feature_bias, const Eigen::Vector2f &pos, float width, float height);
-    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, std::vector<std::shared_ptr<EvoBoid>> &boids) override;
+    void AddBoids(const World &world, const std::shared_ptr<SimulationConfig> &config, EvoBoidStore &boids) override;
     void Draw(sf::RenderWindow* window) const override;
     bool IsInside(Eigen::Vector2f pos, float radius) override;
 
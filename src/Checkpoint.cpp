@@ -0,0 +1,284 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "Checkpoint.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+namespace {
+    constexpr char MAGIC[4] = {'L', 'B', 'C', 'P'};
+    constexpr uint32_t VERSION = 3;
+
+    struct CheckpointHeader {
+        char magic[4];
+        uint32_t version;
+        int32_t type;               // SimulationType
+        int32_t language_size;      // evolution simulations only
+        uint64_t step_nr;
+        float total_simulation_time;
+        uint32_t num_boids;
+    };
+
+    template<typename T>
+    void Write(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    T Read(std::istream& in) {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+    void WriteVector2f(std::ostream& out, const Eigen::Vector2f& vector) {
+        Write(out, vector.x());
+        Write(out, vector.y());
+    }
+
+    Eigen::Vector2f ReadVector2f(std::istream& in) {
+        float x = Read<float>(in);
+        float y = Read<float>(in);
+        return {x, y};
+    }
+
+    bool WriteHeader(std::ofstream& file, const Simulator& simulation, SimulationType type, int language_size, int num_boids) {
+        CheckpointHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.type = type;
+        header.language_size = language_size;
+        header.step_nr = simulation.step_nr;
+        header.total_simulation_time = simulation.total_simulation_time;
+        header.num_boids = num_boids;
+        Write(file, header);
+        return file.good();
+    }
+
+    std::optional<CheckpointHeader> ReadHeader(std::ifstream& file, SimulationType type, int language_size) {
+        auto header = Read<CheckpointHeader>(file);
+        if (!file.good() || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+            std::cerr << "Error: Not a checkpoint file (or an unsupported version)." << std::endl;
+            return std::nullopt;
+        }
+        if (header.type != type || header.language_size != language_size) {
+            std::cerr << "Error: Checkpoint does not belong to this type of simulation." << std::endl;
+            return std::nullopt;
+        }
+        return header;
+    }
+
+    // The file must hold exactly the header and 'num_boids' records, checked before anything is read, so a truncated
+    // or corrupt file cannot replace the running simulation or make it allocate a garbage number of boids
+    bool CheckFileSize(const std::string& filename, const CheckpointHeader& header, uintmax_t record_size) {
+        std::error_code error;
+        uintmax_t file_size = std::filesystem::file_size(filename, error);
+        if (error || file_size != sizeof(CheckpointHeader) + header.num_boids * record_size) {
+            std::cerr << "Error: Checkpoint file is truncated or corrupt: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Position, velocity, acceleration and speed limits of a boid
+    struct BaseBoid {
+        Eigen::Vector2f pos;
+        Eigen::Vector2f vel;
+        Eigen::Vector2f acc;
+        float min_speed;
+        float max_speed;
+    };
+    constexpr uintmax_t BASE_BOID_SIZE = 8 * sizeof(float);
+
+    void WriteBaseBoid(std::ostream& out, const BoidStore& boids, int index) {
+        WriteVector2f(out, boids.pos[index]);
+        WriteVector2f(out, boids.vel[index]);
+        WriteVector2f(out, boids.acc[index]);
+        Write(out, boids.min_speed[index]);
+        Write(out, boids.max_speed[index]);
+    }
+
+    BaseBoid ReadBaseBoid(std::istream& in) {
+        BaseBoid boid{};
+        boid.pos = ReadVector2f(in);
+        boid.vel = ReadVector2f(in);
+        boid.acc = ReadVector2f(in);
+        boid.min_speed = Read<float>(in);
+        boid.max_speed = Read<float>(in);
+        return boid;
+    }
+
+    void SetBaseBoidValues(BoidStore& boids, int index, const BaseBoid& boid) {
+        boids.pos[index] = boid.pos;
+        boids.vel[index] = boid.vel;
+        boids.acc[index] = boid.acc;
+        boids.min_speed[index] = boid.min_speed;
+        boids.max_speed[index] = boid.max_speed;
+    }
+
+    // Language status map of a competition boid: -1 for the default map, otherwise the index of the terrain whose map
+    // the boid uses (assigned in the previous step, by the boid's position before it moved)
+    int32_t GetLanguageStatusMapNr(const CompSimulator& simulation, int index) {
+        const auto& terrains = simulation.world.terrains;
+        for (size_t t = 0; t < terrains.size(); ++t) {
+            if (simulation.boids.language_status_map[index] == terrains[t]->language_status_map.get()) {
+                return static_cast<int32_t>(t);
+            }
+        }
+        return -1;
+    }
+
+    const std::map<int, float>* GetLanguageStatusMap(const CompSimulator& simulation, int32_t map_nr) {
+        if (map_nr >= 0 && map_nr < static_cast<int32_t>(simulation.world.terrains.size())) {
+            return simulation.world.terrains[map_nr]->language_status_map.get();
+        }
+        return simulation.default_languages_status_map.get();
+    }
+}
+
+bool checkpoint::SaveCheckpoint(const std::string &filename, const CompSimulator &simulation) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    const CompBoidStore& boids = simulation.boids;
+    WriteHeader(file, simulation, CompSimulation, 0, boids.Size());
+    for (int i = 0; i < boids.Size(); ++i) {
+        WriteBaseBoid(file, boids, i);
+        Write<int32_t>(file, boids.language_key[i]);
+        Write(file, boids.language_satisfaction[i]);
+        Write(file, GetLanguageStatusMapNr(simulation, i));
+    }
+    return file.good();
+}
+
+bool checkpoint::SaveCheckpoint(const std::string &filename, const EvoSimulator &simulation) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    const EvoBoidStore& boids = simulation.boids;
+    WriteHeader(file, simulation, EvoSimulation, simulation.config->LANGUAGE_SIZE, boids.Size());
+    for (int i = 0; i < boids.Size(); ++i) {
+        WriteBaseBoid(file, boids, i);
+        // The packed words as the store keeps them, one bit per feature
+        std::span<const uint64_t> language_words = boids.GetLanguageWords(i);
+        file.write(reinterpret_cast<const char*>(language_words.data()), static_cast<std::streamsize>(language_words.size_bytes()));
+        Write(file, boids.language_influence[i]);
+        Write(file, boids.age[i]);
+    }
+    return file.good();
+}
+
+bool checkpoint::LoadCheckpoint(const std::string &filename, CompSimulator &simulation) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file for reading: " << filename << std::endl;
+        return false;
+    }
+    auto header = ReadHeader(file, CompSimulation, 0);
+    if (!header) return false;
+    if (!CheckFileSize(filename, *header, BASE_BOID_SIZE + 2 * sizeof(int32_t) + sizeof(float))) return false;
+
+    // Decode everything first, the simulation is only changed once the whole file was read
+    struct CompBoid {
+        BaseBoid base;
+        int32_t language_key;
+        float language_satisfaction;
+        int32_t language_status_map_nr;
+    };
+    std::vector<CompBoid> loaded_boids(header->num_boids);
+    for (auto& boid : loaded_boids) {
+        boid.base = ReadBaseBoid(file);
+        boid.language_key = Read<int32_t>(file);
+        boid.language_satisfaction = Read<float>(file);
+        boid.language_status_map_nr = Read<int32_t>(file);
+    }
+    if (!file.good()) {
+        std::cerr << "Error: Checkpoint file is truncated: " << filename << std::endl;
+        return false;
+    }
+
+    CompBoidStore& boids = simulation.boids;
+    boids.RemoveAllBoids();
+    for (const auto& boid : loaded_boids) {
+        int index = boids.AddBoid(boid.base.pos, boid.base.vel, boid.base.acc, boid.language_key);
+        SetBaseBoidValues(boids, index, boid.base);
+        boids.language_satisfaction[index] = boid.language_satisfaction;
+        boids.SetLanguageStatusMap(index, GetLanguageStatusMap(simulation, boid.language_status_map_nr));
+        boids.UpdateColor(index);
+    }
+
+    simulation.step_nr = header->step_nr;
+    simulation.total_simulation_time = header->total_simulation_time;
+    simulation.selected_boid.reset();
+    simulation.spatial_boid_grid.Rebuild(boids.pos);
+    boids.UpdateSprites();
+    return true;
+}
+
+bool checkpoint::LoadCheckpoint(const std::string &filename, EvoSimulator &simulation) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file for reading: " << filename << std::endl;
+        return false;
+    }
+    int language_size = simulation.config->LANGUAGE_SIZE;
+    auto header = ReadHeader(file, EvoSimulation, language_size);
+    if (!header) return false;
+    int language_words = (language_size + 63) / 64;
+    if (!CheckFileSize(filename, *header, BASE_BOID_SIZE + language_words * sizeof(uint64_t) + 2 * sizeof(float))) return false;
+
+    // Decode everything first, the simulation is only changed once the whole file was read
+    struct EvoBoid {
+        BaseBoid base;
+        std::vector<uint64_t> language_words;
+        float language_influence;
+        float age;
+    };
+    std::vector<EvoBoid> loaded_boids(header->num_boids);
+    for (auto& boid : loaded_boids) {
+        boid.base = ReadBaseBoid(file);
+        boid.language_words.resize(language_words);
+        file.read(reinterpret_cast<char*>(boid.language_words.data()), language_words * sizeof(uint64_t));
+        boid.language_influence = Read<float>(file);
+        boid.age = Read<float>(file);
+    }
+    if (!file.good()) {
+        std::cerr << "Error: Checkpoint file is truncated: " << filename << std::endl;
+        return false;
+    }
+    // Bits past the last feature are always zero in the store, distances and the language table depend on it
+    if (language_size % 64 != 0) {
+        for (const auto& boid : loaded_boids) {
+            if (boid.language_words.back() >> (language_size % 64) != 0) {
+                std::cerr << "Error: Checkpoint file is corrupt: " << filename << std::endl;
+                return false;
+            }
+        }
+    }
+
+    EvoBoidStore& boids = simulation.boids;
+    boids.RemoveAllBoids();
+    for (const auto& boid : loaded_boids) {
+        int index = boids.AddBoid(boid.base.pos, boid.base.vel, boid.base.acc, boid.language_words, boid.language_influence);
+        SetBaseBoidValues(boids, index, boid.base);
+        boids.age[index] = boid.age;
+    }
+
+    simulation.step_nr = header->step_nr;
+    simulation.total_simulation_time = header->total_simulation_time;
+    simulation.selected_boid.reset();
+    simulation.spatial_boid_grid.Rebuild(boids.pos);
+    boids.UpdateSprites();
+    return true;
+}
@@ -0,0 +1,25 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+
+#include "Simulator.h"
+
+// Binary snapshots of a running simulation: simulation time, step number and every boid's state. The world, config
+// and spawners are not included, a checkpoint is restored into a simulator created from the same scenario file.
+// The seed also comes from that scenario, so branches forked from one checkpoint can each use a different seed;
+// with the same seed a deterministic run continues exactly as if it had not been interrupted.
+// Values are stored in the native byte order.
+namespace checkpoint {
+    bool SaveCheckpoint(const std::string &filename, const CompSimulator &simulation);
+    bool SaveCheckpoint(const std::string &filename, const EvoSimulator &simulation);
+
+    bool LoadCheckpoint(const std::string &filename, CompSimulator &simulation);
+    bool LoadCheckpoint(const std::string &filename, EvoSimulator &simulation);
+};
+
+#endif //CHECKPOINT_H
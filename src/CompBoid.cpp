@@ -8,31 +8,41 @@
 #include "Boid.h"
 #include "Utility.h"
 
-CompBoid::CompBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-                 int language_key, float perception_radius, float interaction_radius, float separation_radius, float collision_radius)
-    : Boid(std::move(pos), std::move(vel), std::move(acc), config, perception_radius, interaction_radius, separation_radius, collision_radius),
-      language_key(language_key), language_satisfaction(1.f) {
+CompBoidStore::CompBoidStore(const std::shared_ptr<SimulationConfig> &config, bool has_sprites) : BoidStore(config, has_sprites) {
 }
 
-CompBoid::CompBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-                 int language_key)
-    : Boid(std::move(pos), std::move(vel), std::move(acc), config),
-      language_key(language_key), language_satisfaction(1.f) {
+int CompBoidStore::AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, int language_key) {
+    int index = BoidStore::AddBoid(std::move(pos), std::move(vel), std::move(acc), sf::Color::Yellow);
+    this->language_key.push_back(language_key);
+    language_satisfaction.push_back(1.f);
+    updated_language_key.push_back(-1);
+    language_status_map.push_back(nullptr);
+    UpdateColor(index);
+    return index;
 }
 
-std::pair<int, float> CompBoid::GetUpdatedLanguageAndSatisfaction(const std::vector<CompBoid *> &perceived_boids,
-                                              const std::vector<CompBoid *> &interacting_boids,
+void CompBoidStore::RemoveBoid(int index) {
+    SwapRemove(language_key, index);
+    SwapRemove(language_satisfaction, index);
+    SwapRemove(updated_language_key, index);
+    SwapRemove(language_status_map, index);
+    BoidStore::RemoveBoid(index);
+}
+
+std::pair<int, float> CompBoidStore::GetUpdatedLanguageAndSatisfaction(int index,
+                                              const std::vector<int> &perceived_boids,
+                                              const std::vector<int> &interacting_boids,
                                               sf::Time delta_time) const {
     // Calculate language status based on the boids languages within the perception range.
     std::map<int, float> language_status;
-    for (auto& boid : perceived_boids) {
-        language_status[boid->language_key] += 1;
+    for (int boid : perceived_boids) {
+        language_status[language_key[boid]] += 1;
     }
 
     // Calculate the proportion of language speakers based on boids within the interaction range.
     std::map<int, float> language_count;
-    for(auto& boid : interacting_boids) {
-        language_count[boid->language_key] += 1;
+    for(int boid : interacting_boids) {
+        language_count[language_key[boid]] += 1;
     }
 
     // Calculate the language influence as (s * x^a)
@@ -41,24 +51,24 @@ std::pair<int, float> CompBoid::GetUpdatedLanguageAndSatisfaction(const std::vec
     for (auto& count : language_count) {
         int key = count.first;
         float influence = std::pow(count.second / static_cast<float>(interacting_boids.size()), config->a_COEFFICIENT) *
-                          (language_status[key] * language_status_map->at(key) / static_cast<float>(perceived_boids.size()));
+                          (language_status[key] * language_status_map[index]->at(key) / static_cast<float>(perceived_boids.size()));
         total_influence_val += influence;
         language_influence[key] = influence;
     }
 
     // Based on the language influence, sample r to check whether influence of current language increases or decreases.
     float satisfaction = 0;
-     if (float r = GetRandomFloatBetween(0, total_influence_val); r <= language_influence[this->language_key]) {
+     if (float r = GetRandomFloatBetween(0, total_influence_val); r <= language_influence[language_key[index]]) {
          // Increase current language satisfaction
-         satisfaction = this->language_satisfaction + config->CONVERSION_RATE * delta_time.asSeconds();
+         satisfaction = language_satisfaction[index] + config->CONVERSION_RATE * delta_time.asSeconds();
      } else {
          // Decrease current language satisfaction
-         satisfaction = this->language_satisfaction - config->CONVERSION_RATE * delta_time.asSeconds();
+         satisfaction = language_satisfaction[index] - config->CONVERSION_RATE * delta_time.asSeconds();
      }
 
-    // float satisfaction = this->language_satisfaction;
+    // float satisfaction = language_satisfaction[index];
     // for (const auto& [key, influence] : language_influence) {
-    //     if (key == this->language_key) {
+    //     if (key == language_key[index]) {
     //         satisfaction += influence * config->CONVERSION_RATE * delta_time.asSeconds();
     //     } else {
     //         satisfaction -= influence * config->CONVERSION_RATE * delta_time.asSeconds();
@@ -67,13 +77,13 @@ std::pair<int, float> CompBoid::GetUpdatedLanguageAndSatisfaction(const std::vec
 
 
     // change language if current satisfaction goes below zero
-    int language = this->language_key;
-    if (this->language_satisfaction <= 0) {
+    int language = language_key[index];
+    if (language_satisfaction[index] <= 0) {
         satisfaction = 1;
         float max_influence = -1.0f;
         // Get language with maximum influence
         for (const auto&[key, influence] : language_influence) {
-            if (influence > max_influence && key != this->language_key) {
+            if (influence > max_influence && key != language_key[index]) {
                 language = key;
                 max_influence = influence;
             }
@@ -82,20 +92,21 @@ std::pair<int, float> CompBoid::GetUpdatedLanguageAndSatisfaction(const std::vec
     return {language, satisfaction};
 }
 
-void CompBoid::UpdateLanguageSatisfaction(const std::vector<CompBoid *>& perceived_boids,
-                                       const std::vector<CompBoid *>& interacting_boids,
+void CompBoidStore::UpdateLanguageSatisfaction(int index,
+                                       const std::vector<int>& perceived_boids,
+                                       const std::vector<int>& interacting_boids,
                                        sf::Time delta_time) {
 
     // Calculate language status based on the boids languages within the perception range.
     std::map<int, float> language_status;
-    for (auto& boid : perceived_boids) {
-        language_status[boid->language_key] += 1;
+    for (int boid : perceived_boids) {
+        language_status[language_key[boid]] += 1;
     }
 
     // Calculate the proportion of language speakers based on boids within the interaction range.
     std::map<int, float> language_proportion;
-    for(auto& boid : interacting_boids) {
-        language_proportion[boid->language_key] += 1;
+    for(int boid : interacting_boids) {
+        language_proportion[language_key[boid]] += 1;
     }
 
     // Calculate the language influence as (s * x^a)
@@ -104,72 +115,72 @@ void CompBoid::UpdateLanguageSatisfaction(const std::vector<CompBoid *>& perceiv
     for (auto& language : language_proportion) {
         int key = language.first;
         float influence = std::pow(language.second / static_cast<float>(interacting_boids.size()), config->a_COEFFICIENT) *
-                          (language_status[key] * language_status_map->at(key) / static_cast<float>(perceived_boids.size()));
+                          (language_status[key] * language_status_map[index]->at(key) / static_cast<float>(perceived_boids.size()));
         total_influence_val += influence;
         language_influence[key] = influence;
     }
 
     // Based on the language influence, sample r to check whether influence of current language increases or decreases.
-    if (float r = GetRandomFloatBetween(0, total_influence_val); r <= language_influence[this->language_key]) {
+    if (float r = GetRandomFloatBetween(0, total_influence_val); r <= language_influence[language_key[index]]) {
         // Increase current language satisfaction
-        SetLanguageSatisfaction(this->language_satisfaction + config->CONVERSION_RATE * delta_time.asSeconds());
+        SetLanguageSatisfaction(index, language_satisfaction[index] + config->CONVERSION_RATE * delta_time.asSeconds());
     } else {
         // Decrease current language satisfaction
-        SetLanguageSatisfaction(this->language_satisfaction - config->CONVERSION_RATE * delta_time.asSeconds());
+        SetLanguageSatisfaction(index, language_satisfaction[index] - config->CONVERSION_RATE * delta_time.asSeconds());
     }
 
     // change language if current influence goes below zero
-    if (this->language_satisfaction <= 0) {
+    if (language_satisfaction[index] <= 0) {
         float max_influence = -1.0f;
         // Get language with maximum influence
         for (const auto&[key, influence] : language_influence) {
             if (influence > max_influence) {
-                updated_language_key = key;
+                updated_language_key[index] = key;
                 max_influence = influence;
             }
         }
     }
 }
 
-void CompBoid::UpdateLanguage() {
-    if (updated_language_key != -1) {
-        SetLanguageKey(updated_language_key);
-        SetLanguageSatisfaction(1.f);
+void CompBoidStore::UpdateLanguage(int index) {
+    if (updated_language_key[index] != -1) {
+        SetLanguageKey(index, updated_language_key[index]);
+        SetLanguageSatisfaction(index, 1.f);
 
         //Reset new_language_key
-        updated_language_key = -1;
+        updated_language_key[index] = -1;
     }
 }
 
-void CompBoid::SetLanguageSatisfaction(float value) {
-    this->language_satisfaction = std::min(1.f, value);
+void CompBoidStore::SetLanguageSatisfaction(int index, float value) {
+    language_satisfaction[index] = std::min(1.f, value);
 }
 
-void CompBoid::SetLanguageStatusMap(const std::shared_ptr<std::map<int, float>> &language_status_map) {
-    this->language_status_map = language_status_map;
+void CompBoidStore::SetLanguageStatusMap(int index, const std::map<int, float> *language_status_map) {
+    this->language_status_map[index] = language_status_map;
 }
 
-Eigen::Vector2f CompBoid::GetUpdatedAcceleration(const std::vector<CompBoid*>& interacting_boids) const {
+Eigen::Vector2f CompBoidStore::GetUpdatedAcceleration(int index, const std::vector<int>& interacting_boids) const {
 
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
     if (!interacting_boids.empty()) {
         //Coherence & Alignment
-        acceleration += CalcCoherenceAlignmentAcceleration(interacting_boids);
+        acceleration += CalcCoherenceAlignmentAcceleration(index, interacting_boids);
         //Avoidance
-        acceleration += CalcAvoidanceAcceleration(interacting_boids);
+        acceleration += CalcAvoidanceAcceleration(index, interacting_boids);
         //Separation
-        acceleration += CalcSeparationAcceleration(interacting_boids);
+        acceleration += CalcSeparationAcceleration(index, interacting_boids);
     }
     return acceleration;
 }
 
-void CompBoid::UpdateAcceleration(const std::vector<CompBoid *>& interacting_boids) {
-    Eigen::Vector2f acceleration = GetUpdatedAcceleration(interacting_boids);
-    SetAcceleration(acceleration);
+void CompBoidStore::UpdateAcceleration(int index, const std::vector<int>& interacting_boids) {
+    Eigen::Vector2f acceleration = GetUpdatedAcceleration(index, interacting_boids);
+    SetAcceleration(index, acceleration);
 }
 
 
-Eigen::Vector2f CompBoid::CalcCoherenceAlignmentAcceleration(const std::vector<CompBoid*> &nearby_boids) const {
+Eigen::Vector2f CompBoidStore::CalcCoherenceAlignmentAcceleration(int index, const std::vector<int> &nearby_boids) const {
 
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
     float similar_boids = 0;
@@ -177,10 +188,10 @@ Eigen::Vector2f CompBoid::CalcCoherenceAlignmentAcceleration(const std::vector<C
     // Calculate average position and velocity of neighbouring boids, using the language similarity as weight.
     Eigen::Vector2f avg_pos = Eigen::Vector2f::Zero();
     Eigen::Vector2f avg_vel = Eigen::Vector2f::Zero();
-    for (auto& boid : nearby_boids) {
-        if (boid->language_key == this->language_key) {
-            avg_pos += boid->pos;
-            avg_vel += boid->vel;
+    for (int boid : nearby_boids) {
+        if (language_key[boid] == language_key[index]) {
+            avg_pos += pos[boid];
+            avg_vel += vel[boid];
             similar_boids++;
         }
     }
@@ -190,57 +201,40 @@ Eigen::Vector2f CompBoid::CalcCoherenceAlignmentAcceleration(const std::vector<C
         avg_vel = avg_vel / similar_boids;
 
         // COHERENCE
-        Eigen::Vector2f pos_difference = avg_pos - this->pos;
-        acceleration = pos_difference.normalized() * config->COHESION_FACTOR * max_speed;
+        Eigen::Vector2f pos_difference = avg_pos - pos[index];
+        acceleration = pos_difference.normalized() * config->COHESION_FACTOR * max_speed[index];
 
         // ALIGNMENT
-        Eigen::Vector2f vel_difference = (avg_vel - this->vel);
-        acceleration += vel_difference.normalized() * config->ALIGNMENT_FACTOR * max_speed;
-    }
-
-    return acceleration;
-}
-
-
-Eigen::Vector2f CompBoid::CalcSeparationAcceleration(const std::vector<CompBoid*>& interacting_boids) const {
-
-    Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
-    float squared_separation_radius = separation_radius * separation_radius;
-
-    for (auto & boid : interacting_boids) {
-        Eigen::Vector2f pos_difference = boid->pos - this->pos;
-        float squared_distance = pos_difference.squaredNorm();
-        if (squared_distance <= squared_separation_radius) {
-            float strength = std::pow((squared_separation_radius - squared_distance) / squared_separation_radius, 2);
-            acceleration -= pos_difference.normalized() * max_speed * config->SEPARATION_FACTOR * (strength);
-        }
+        Eigen::Vector2f vel_difference = (avg_vel - vel[index]);
+        acceleration += vel_difference.normalized() * config->ALIGNMENT_FACTOR * max_speed[index];
     }
 
     return acceleration;
 }
 
 
-Eigen::Vector2f CompBoid::CalcAvoidanceAcceleration(const std::vector<CompBoid*>& nearby_boids) const {
+Eigen::Vector2f CompBoidStore::CalcAvoidanceAcceleration(int index, const std::vector<int>& nearby_boids) const {
 
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
     const float squared_interaction_radius = interaction_radius * interaction_radius;
 
-    for (auto& boid : nearby_boids) {
-        if (boid->language_key != this->language_key) {
-            Eigen::Vector2f pos_difference = boid->pos - this->pos;
+    for (int boid : nearby_boids) {
+        if (language_key[boid] != language_key[index]) {
+            Eigen::Vector2f pos_difference = pos[boid] - pos[index];
             float squared_distance = pos_difference.squaredNorm();
             float strength = std::pow((squared_interaction_radius - squared_distance) / squared_interaction_radius, 2);
-            acceleration -= pos_difference.normalized() * max_speed * config->AVOIDANCE_FACTOR * (strength);
+            acceleration -= pos_difference.normalized() * max_speed[index] * config->AVOIDANCE_FACTOR * (strength);
         }
     }
     return acceleration;
 }
 
-void CompBoid::SetLanguageKey(int key) {
-    this->language_key = key;
-    UpdateColor();
+void CompBoidStore::SetLanguageKey(int index, int key) {
+    language_key[index] = key;
+    UpdateColor(index);
 }
 
-void CompBoid::UpdateColor() {
-    this->sprite.setColor(LanguageManager::GetLanguageColor(language_key));
-}
\ No newline at end of file
+void CompBoidStore::UpdateColor(int index) {
+    if (!has_sprites) return;
+    sprites[index].setColor(LanguageManager::GetLanguageColor(language_key[index]));
+}
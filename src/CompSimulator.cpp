@@ -7,6 +7,7 @@
 #include <execution>
 
 #include "Application.h"
+#include "Checkpoint.h"
 #include "BoidSpawners.h"
 #include "LanguageManager.h"
 #include "Simulator.h"
@@ -15,11 +16,14 @@
 
 CompSimulator::CompSimulator(std::shared_ptr<Context>& context, KeySimulationData& simulation_data, std::string simulation_name, float camera_width, float camera_height)
     : Simulator(context, simulation_data.config, simulation_data.world, camera_width, camera_height),
+      spatial_boid_grid(SpatialGrid(world.size().cast<int>(), static_cast<int>(config->INTERACTION_RADIUS))),
+      boids(config, !context->headless),
       boid_spawners(simulation_data.boid_spawners),
-      num_threads(std::max(std::thread::hardware_concurrency() - 1.f, 1.f)),
-      spatial_boid_grid(SpatialGrid<CompBoid>(world.size().cast<int>(), static_cast<int>(config->INTERACTION_RADIUS))),
+      num_threads(context->thread_pool->Size()),
       output_file_path("output/" + simulation_name)
 {
+    checkpoint_file_path = "output/" + simulation_name + "_checkpoint.bin";
+
     std::map<int, int> languages;
     std::map<int, float> default_languages_status_map;
     for (auto &spawner: boid_spawners) {
@@ -42,6 +46,10 @@ CompSimulator::CompSimulator(std::shared_ptr<Context>& context, KeySimulationDat
     }
 }
 
+void CompSimulator::EnableTrajectoryOutput() {
+    if (analyser) analyser->StreamPositionsTo(output_file_path + "_trajectory.bin");
+}
+
 void CompSimulator::Init() {
 
     // Setup world borders
@@ -51,159 +59,157 @@ void CompSimulator::Init() {
     camera.FitWorld(world);
 
     // Spawn Boids
+    SeedRandomStream(SEQUENTIAL_STREAM);
     for (auto& spawner : boid_spawners) {
         spawner->AddBoids(world, config, boids);
     }
 
     // Initialize boids in spatial grid
-    for (auto& boid : boids) {
-        spatial_boid_grid.AddObj(boid);
-    }
+    spatial_boid_grid.Rebuild(boids.pos);
 
-    for (auto& boid : boids) {
-        boid->UpdateColor();
-        boid->SetLanguageStatusMap(default_languages_status_map);
-    }
-
-    // Divide boids into chunks for multi-threading
-    if (config->MULTI_THREADING) {
-        DivideBoidChunks();
+    for (int i = 0; i < boids.Size(); ++i) {
+        boids.UpdateColor(i);
+        boids.SetLanguageStatusMap(i, default_languages_status_map.get());
     }
 }
 
-void CompSimulator::DivideBoidChunks() {
-    // Split the boids vector into chunks for each thread
-    boid_chunks.resize(num_threads);
-    for (size_t i = 0; i < boids.size(); ++i) {
-        boid_chunks[i % num_threads].push_back(boids[i]);
-    }
-}
+void CompSimulator::UpdateBoidsStepOneMultithread(std::span<const int> boid_indices, sf::Time delta_time,
+                                                  UpdatedBoidValues &boid_values) const {
 
-CompSimulator::UpdatedBoidValues CompSimulator::UpdateBoidsStepOneMultithread(const std::vector<std::shared_ptr<CompBoid> > &boids, sf::Time delta_time) const {
+    // Per-thread neighbour buffers, reused for every boid so the search does not allocate in steady state
+    thread_local std::vector<int> interacting_boids;
+    thread_local std::vector<int> perceived_boids;
 
-    UpdatedBoidValues updated_boid_values;
-    for (const auto& boid : boids) {
-        //Get boids in perception radius:
-        std::vector<CompBoid*> interacting_boids = spatial_boid_grid.ObjRadiusSearch(boid->interaction_radius, boid);
-        std::vector<CompBoid*> perceived_boids = spatial_boid_grid.ObjRadiusSearch(boid->perception_radius, boid);
+    // Every boid is handled by exactly one thread, so each thread only writes to the slots of its own boids
+    for (int i : boid_indices) {
+        SeedRandomStream(i);
+
+        //Get boids in interaction and perception radius (in a single grid sweep):
+        spatial_boid_grid.ObjDualRadiusSearch(boids.interaction_radius, boids.perception_radius, i,
+                                              interacting_boids, perceived_boids);
 
         //Update boids acceleration
-        updated_boid_values.acceleration_values[boid.get()] = boid->GetUpdatedAcceleration(interacting_boids);
+        boid_values.acceleration_values[i] = boids.GetUpdatedAcceleration(i, interacting_boids);
 
         //Update boids language satisfaction
-        updated_boid_values.language_and_satisfaction_values[boid.get()] = boid->GetUpdatedLanguageAndSatisfaction(perceived_boids,
-                                                                                                                   interacting_boids,
-                                                                                                                   delta_time);
+        boid_values.language_and_satisfaction_values[i] = boids.GetUpdatedLanguageAndSatisfaction(i,
+                                                                                                  perceived_boids,
+                                                                                                  interacting_boids,
+                                                                                                  delta_time);
     }
-    return updated_boid_values;
 }
 
-void CompSimulator::UpdateBoidsStepOne(const std::vector<std::shared_ptr<CompBoid>>& boids, sf::Time delta_time) const {
-    for (const auto& boid : boids) {
+void CompSimulator::UpdateBoidsStepOne(sf::Time delta_time) {
+    std::vector<int> interacting_boids;
+    std::vector<int> perceived_boids;
+    for (int i = 0; i < boids.Size(); ++i) {
+        SeedRandomStream(i);
 
-        //Get boids in perception radius:
-        std::vector<CompBoid*> interacting_boids = spatial_boid_grid.ObjRadiusSearch(boid->interaction_radius, boid);
-        std::vector<CompBoid*> perceived_boids = spatial_boid_grid.ObjRadiusSearch(boid->perception_radius, boid);
+        //Get boids in interaction and perception radius (in a single grid sweep):
+        spatial_boid_grid.ObjDualRadiusSearch(boids.interaction_radius, boids.perception_radius, i,
+                                              interacting_boids, perceived_boids);
 
         //Update boids acceleration
-        boid->UpdateAcceleration(interacting_boids);
+        boids.UpdateAcceleration(i, interacting_boids);
 
         //Update boids language satisfaction
-        boid->UpdateLanguageSatisfaction(perceived_boids, interacting_boids, delta_time);
+        boids.UpdateLanguageSatisfaction(i, perceived_boids, interacting_boids, delta_time);
     }
 }
 
-void CompSimulator::UpdateBoidsStepTwo(const std::vector<std::shared_ptr<CompBoid>>& boids, sf::Time delta_time) {
-    for (const auto& boid : boids) {
+void CompSimulator::UpdateBoidsStepTwo(sf::Time delta_time) {
+    for (int i = 0; i < boids.Size(); ++i) {
 
         //Update boid behaviour based on terrain effects
         bool in_terrain = false;
         for (auto& terrain : world.terrains) {
-            if (terrain->IsPointInside(boid->pos)) {
-                terrain->ApplyMovementEffects(boid.get());
-                terrain->ApplyLanguageStatusEffects(boid.get());
+            if (terrain->IsPointInside(boids.pos[i])) {
+                terrain->ApplyMovementEffects(boids, i);
+                terrain->ApplyLanguageStatusEffects(boids, i);
                 in_terrain = true;
             }
         }
         if (!in_terrain) {
-            boid->SetDefaultMinMaxSpeed();
-            boid->SetLanguageStatusMap(default_languages_status_map);
+            boids.SetDefaultMinMaxSpeed(i);
+            boids.SetLanguageStatusMap(i, default_languages_status_map.get());
         }
 
         //Update boids velocity (Also checking Collisions)
-        boid->UpdateVelocity(world.obstacles, delta_time);
+        boids.UpdateVelocity(i, world.obstacles, delta_time);
 
         //Update boids position
-        boid->UpdatePosition(delta_time);
-        spatial_boid_grid.UpdateObj(boid);
+        boids.UpdatePosition(i, delta_time);
 
         //Update boids language
         //TODO: split multi-thread and single thread, this function is useless in multi (updated_language_key is always -1)
-        boid->UpdateLanguage();
-
-        //Update boids sprite
-        boid->UpdateSprite();
+        boids.UpdateLanguage(i);
     }
+
+    // Re-sort the spatial grid for the next update
+    spatial_boid_grid.Rebuild(boids.pos);
 }
 
 // Log metrics based on interval settings
 //analyser.LogAllMetrics(delta_time);
 void CompSimulator::Update(sf::Time delta_time) {
 
-    if (speed_up_sumlation) {
-        if (delta_time < sf::seconds(1/30.f)) { delta_time = sf::seconds(1/30.f); }
-    }
-
-    if (config->MULTI_THREADING) {
-        std::vector<std::future<UpdatedBoidValues>> future_pool;
-        std::vector<UpdatedBoidValues> partial_values(num_threads);
-
-        // Launch threads
-        for (size_t i = 0; i < num_threads; ++i) {
-            future_pool.emplace_back(std::async(std::launch::async, [&](size_t thread_id) {
-                return UpdateBoidsStepOneMultithread(boid_chunks[thread_id], delta_time);
-            }, i));
+    if (fast_forward) {
+        RunFastForwardTicks([this] { Step(sf::seconds(FIXED_TIME_STEP)); });
+    } else {
+        if (speed_up_sumlation) {
+            if (delta_time < sf::seconds(1/30.f)) { delta_time = sf::seconds(1/30.f); }
         }
+        Step(delta_time);
+    }
 
-        // Collect partial results from futures
-        std::mutex resultsMutex;
-        for (size_t i = 0; i < num_threads; ++i) {
-            std::lock_guard lock(resultsMutex);
-            partial_values[i] = future_pool[i].get();
-        }
+    // Sprites only have to match the state that is drawn
+    boids.UpdateSprites();
+}
 
-        // Combine partial results
-        UpdatedBoidValues all_updated_values;
-        for (const auto& partial : partial_values) {
-            for (const auto& entry : partial.acceleration_values) {
-                all_updated_values.acceleration_values.insert(entry);
-            }
-            for (const auto& entry : partial.language_and_satisfaction_values) {
-                all_updated_values.language_and_satisfaction_values.insert(entry);
-            }
+void CompSimulator::Step(sf::Time delta_time) {
+    // Deterministic runs cannot depend on the frame rate
+    if (IsDeterministic()) delta_time = sf::seconds(FIXED_TIME_STEP);
+
+    // Deterministic runs always compute the new values into the slot arrays first (on a single thread without
+    // MULTI_THREADING), so every boid reads the same state whatever the number of threads
+    if (config->MULTI_THREADING || IsDeterministic()) {
+        updated_boid_values.acceleration_values.resize(boids.Size());
+        updated_boid_values.language_and_satisfaction_values.resize(boids.Size());
+
+        std::span<const int> cell_ordered_boids(spatial_boid_grid.cell_boids);
+        if (config->MULTI_THREADING) {
+            // Divide the boids (in grid cell order) into chunks with a similar amount of work. Threads keep taking the
+            // next chunk from the thread pool, which returns once all chunks are done.
+            int num_chunks = static_cast<int>(num_threads) * WORK_CHUNKS_PER_THREAD;
+            spatial_boid_grid.CreateWorkChunks(num_chunks, work_chunk_start);
+            context->thread_pool->Run(num_chunks, [&](int chunk) {
+                auto chunk_boids = cell_ordered_boids.subspan(work_chunk_start[chunk], work_chunk_start[chunk + 1] - work_chunk_start[chunk]);
+                UpdateBoidsStepOneMultithread(chunk_boids, delta_time, updated_boid_values);
+            });
+        } else {
+            UpdateBoidsStepOneMultithread(cell_ordered_boids, delta_time, updated_boid_values);
         }
 
         // Apply value updates to boids
-        for (auto& boid : boids) {
-            auto& acceleration_value = all_updated_values.acceleration_values[boid.get()];
-            boid->SetAcceleration(acceleration_value);
-            auto& language_and_satisfaction_value = all_updated_values.language_and_satisfaction_values[boid.get()];
-            boid->SetLanguageKey(language_and_satisfaction_value.first);
-            boid->SetLanguageSatisfaction(language_and_satisfaction_value.second);
-
+        for (int i = 0; i < boids.Size(); ++i) {
+            boids.SetAcceleration(i, updated_boid_values.acceleration_values[i]);
+            auto& [language_key, language_satisfaction] = updated_boid_values.language_and_satisfaction_values[i];
+            boids.SetLanguageKey(i, language_key);
+            boids.SetLanguageSatisfaction(i, language_satisfaction);
         }
     } else {
-        UpdateBoidsStepOne(boids, delta_time);
+        UpdateBoidsStepOne(delta_time);
     }
 
     // Update boids position, language, and sprite sequentially
-    UpdateBoidsStepTwo(boids, delta_time);
+    UpdateBoidsStepTwo(delta_time);
 
     // Log analysis data if analysing is enabled
     if (analyser) analyser->LogAllMetrics(delta_time);
 
     // Increment simulation time
     total_simulation_time += delta_time.asSeconds();
+    step_nr++;
 }
 
 void CompSimulator::ProcessInput() {
@@ -218,7 +224,7 @@ void CompSimulator::ProcessInput() {
         if (event.type == sf::Event::MouseButtonPressed) {
             if (event.mouseButton.button == sf::Mouse::Left) {
                 //Boid Selection
-                ProcessBoidSelection(context.get(), mouse_pos, spatial_boid_grid);
+                ProcessBoidSelection(context.get(), mouse_pos, spatial_boid_grid, boids);
             }
             if (event.mouseButton.button == sf::Mouse::Middle) {
                 //Camera Drag
@@ -248,11 +254,24 @@ void CompSimulator::ProcessInput() {
             std::cout << "Speed up Simulation: " << speed_up_sumlation << std::endl;
         }
 
+        if (IsKeyPressedOnce(sf::Keyboard::F)) {
+            fast_forward = !fast_forward;
+            std::cout << "Fast-forward Simulation: " << fast_forward << std::endl;
+        }
+
         if (IsKeyPressedOnce(sf::Keyboard::F5)) {
             analyser->SaveBoidPerLanguageToCSV(output_file_path + "_language_output.txt");
             analyser->SavePositionPerLanguageCSV(output_file_path + "_position_output.txt");
         }
 
+        if (IsKeyPressedOnce(sf::Keyboard::F6)) {
+            if (checkpoint::SaveCheckpoint(checkpoint_file_path, *this)) std::cout << "Saved Checkpoint to:" << checkpoint_file_path << std::endl;
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::F9)) {
+            if (checkpoint::LoadCheckpoint(checkpoint_file_path, *this)) std::cout << "Loaded Checkpoint:" << checkpoint_file_path << std::endl;
+        }
+
         if (IsKeyPressedOnce(sf::Keyboard::Escape)) {
             context->state_manager->PopState();
         }
@@ -273,8 +292,8 @@ void CompSimulator::DrawWorldAndBoids() {
     spatial_boid_grid.DrawGrid(context->window.get());
 
     // Draw Boids
-    for (const auto& boid : boids) {
-        context->window->draw(boid->sprite);
+    for (const auto& sprite : boids.sprites) {
+        context->window->draw(sprite);
     }
 
     // Draw Obstacles
@@ -283,7 +302,7 @@ void CompSimulator::DrawWorldAndBoids() {
     }
 
     // Draw Boid Selection Circle
-    DrawBoidSelectionCircle();
+    DrawBoidSelectionCircle(boids);
 
     // Reset camera view to default
     context->window->setView(context->window->getDefaultView());
@@ -315,8 +334,3 @@ void CompSimulator::Start() {
 void CompSimulator::Pause() {
 
 }
-
-void CompSimulator::AddBoid(const std::shared_ptr<CompBoid> &boid) {
-    boids.push_back(boid);           // creates a copy of shared_ptr, assigning an additional owner (the 'boids' vector)
-    spatial_boid_grid.AddObj(boid);
-}
@@ -4,6 +4,8 @@
 
 #include "CompStudySimulator.h"
 
+#include <algorithm>
+#include <cmath>
 #include <format>
 #include <filesystem>
 #include <fstream>
@@ -53,6 +55,10 @@ void CompStudySimulator::Init() {
     SetupCurrentFraction(current_distrubution_nr);
 }
 
+bool CompStudySimulator::IsFinished() const {
+    return current_distrubution_nr >= simulation_data.config->FRACTIONS;
+}
+
 void CompStudySimulator::ShowDisplayDisabledMessage() {
     std::cout << "Disabling Display " << std::endl;
     context->window->clear(sf::Color::Black);
@@ -116,6 +122,8 @@ void CompStudySimulator::SetupCurrentFraction(int number) {
 
     // Reset run number to 0
     current_run_nr = 0;
+    parallel_simulations.clear();
+    parallel_run_results.clear();
 
     // Reset Data vectors
     run_outcomes.clear();
@@ -138,11 +146,15 @@ void CompStudySimulator::SetNextInitalFraction() {
 }
 
 void CompStudySimulator::Update(sf::Time delta_time) {
-    if (delta_time < sf::seconds(1/30.f)) { delta_time = sf::seconds(1/30.f); }
+    if (IsFinished()) {
+        // No interface in headless runs
+        if (escape_interface) escape_interface->Activate();
+        if (study_interface) study_interface->Deactivate();
+    }
 
-    if (current_distrubution_nr >= simulation_data.config->FRACTIONS) {
-        escape_interface->Activate();
-        study_interface->Deactivate();
+    // Simulate the remaining runs of this fraction concurrently when they are not displayed
+    else if (!current_simulation && (!parallel_simulations.empty() || UseParallelRuns())) {
+        UpdateParallelRuns();
     }
 
     //Check if simulation is running.
@@ -150,79 +162,198 @@ void CompStudySimulator::Update(sf::Time delta_time) {
         // Start new run of current inital population fraction
         current_simulation = std::make_unique<CompSimulator>(context, simulation_data, "study", camera.default_width, camera.default_height);
         current_simulation->camera = camera;
+        // Every run gets its own seed, so a deterministic study can reproduce a single run
+        current_simulation->seed = CreateStreamSeed(simulation_data.config->SEED, current_distrubution_nr, current_run_nr);
         current_simulation->Init();
+        if (!study_interface) return;
 
         std::string fractionString = std::format("Fraction: {} of {} ({}, {})", current_distrubution_nr, simulation_data.config->FRACTIONS,
                                                       current_initial_fraction[0], current_initial_fraction[1]);
         study_interface->fraction_fld->text.setString(fractionString);
 
         // Update run number text
-        std::string runNumberString = std::format("Run: {} of {}", current_run_nr, simulation_data.config->RUNS_PER_FRACTION);
+        std::string runNumberString = std::format("Run: {} of {}", current_run_nr, MaxRunsPerFraction());
         study_interface->run_fld->text.setString(runNumberString);
     }
     else {
-        //Update Simulation
-        current_simulation->Update(delta_time);
+        //Update Simulation, with the same fixed time step as the parallel runs so displaying a run doesn't change its outcome
+        current_simulation->Step(sf::seconds(Simulator::FIXED_TIME_STEP));
+        current_simulation->boids.UpdateSprites();
 
         // Update Interface
-        study_interface->simulation_time_fld->text.setString("Simulation Time: " + std::to_string(current_simulation->total_simulation_time));
+        if (study_interface) {
+            study_interface->simulation_time_fld->text.setString("Simulation Time: " + std::to_string(current_simulation->total_simulation_time));
+        }
 
         // Check terminating conditions
-        std::map<int, int> fraction = {{0, 0},
-                                           {1, 0}};
-        for (auto& boid : current_simulation->boids) {
-            fraction[boid->language_key]++;
+        if (auto result = GetRunResult(*current_simulation)) {
+            // Stop current simulation
+            current_simulation.reset(nullptr);
+            AddRunResult(*result);
+            if (IsFractionComplete()) FinishFraction();
         }
+    }
+}
 
-        if ( fraction[0] == 0 || fraction[1] == 0 || current_simulation->total_simulation_time >= simulation_data.config->TIME_STEPS_PER_RUN) {
-            // Log the necessary data about the simulations outcome
-            int dominating_language_key = -1;
-            if (fraction[0] == 0) {
-                dominating_language_key = 1;
-            } else if (fraction[1] == 0) {
-                dominating_language_key = 0;
-            }
-            run_outcomes.push_back(dominating_language_key);
+bool CompStudySimulator::UseParallelRuns() const {
+    return context->headless || !display_simulation;
+}
 
-            std::array final_fraction = {fraction[0], fraction[1]};
-            run_final_fraction.push_back(final_fraction);
+void CompStudySimulator::StartParallelRuns() {
+    // The runs themselves are the parallel work, a run using the thread pool would wait on its own task
+    KeySimulationData run_data = simulation_data;
+    run_data.config = std::make_shared<SimulationConfig>(*simulation_data.config);
+    run_data.config->MULTI_THREADING = false;
+    // Study runs are never saved, an analyser per concurrent run would only fill memory (and start a thread per run)
+    run_data.config->ANALYSIS_LOG_INTERVAL = 0;
+
+    // An adaptive study starts a batch of about one run per thread, and checks the confidence interval after each batch
+    int num_runs = MaxRunsPerFraction() - current_run_nr;
+    if (IsAdaptive()) {
+        num_runs = std::min(num_runs, std::max(ADAPTIVE_MIN_RUNS - current_run_nr, static_cast<int>(context->thread_pool->Size())));
+    }
+
+    // Constructors run sequentially, they initialise the (shared) terrain status maps
+    for (int i = 0; i < num_runs; ++i) {
+        auto simulation = std::make_unique<CompSimulator>(context, run_data, "study", camera.default_width, camera.default_height);
+        simulation->camera = camera;
+        simulation->seed = CreateStreamSeed(simulation_data.config->SEED, current_distrubution_nr, current_run_nr + i);
+        parallel_simulations.push_back(std::move(simulation));
+    }
+    parallel_run_results.assign(num_runs, std::nullopt);
 
-            run_times.push_back(std::min(static_cast<double>(current_simulation->total_simulation_time), static_cast<double>(simulation_data.config->TIME_STEPS_PER_RUN)));
+    // Spawning only reads the spawners, so the runs can be initialised concurrently
+    context->thread_pool->Run(num_runs, [&](int run) {
+        parallel_simulations[run]->Init();
+    });
 
-            // Get current system time
-            std::time_t current_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-            std::tm* time_info = std::localtime(&current_time);
+    if (!study_interface) return;
+    std::string fractionString = std::format("Fraction: {} of {} ({}, {})", current_distrubution_nr, simulation_data.config->FRACTIONS,
+                                                  current_initial_fraction[0], current_initial_fraction[1]);
+    study_interface->fraction_fld->text.setString(fractionString);
+}
 
-            // Print the time in the format HH:MM:SS
-            std::cout << "["<<std::put_time(time_info, "%H:%M:%S") << "] Run Complete! Dominating Language: " << dominating_language_key
-                      << ", Simulated time steps: " << current_simulation->total_simulation_time << std::endl;
+void CompStudySimulator::UpdateParallelRuns() {
+    if (parallel_simulations.empty()) {
+        StartParallelRuns();
+    }
 
-            // Stop current simulation
-            current_simulation.reset(nullptr);
-            current_run_nr++;
-
-            // Check if all runs for this fraction have been simulated
-            if (current_run_nr >= simulation_data.config->RUNS_PER_FRACTION) {
-
-                // Check if the current initial fraction had a one-sided dominant outcome.
-                if (current_distrubution_nr != 0 && !run_outcomes.empty()) {
-                    if (std::ranges::adjacent_find(run_outcomes, std::not_equal_to<>()) == run_outcomes.end() )
-                    {
-                        auto language_key = run_outcomes[0];
-                        one_sided_outcome_found[language_key] = true;
-                        std::cout << "one-sided dominanance found for language: " << language_key << std::endl;
-                    }
-                }
-
-                // Log analysis data to the output file
-                LogDataToFile(output_file_path, current_distrubution_nr, current_initial_fraction, run_outcomes, run_times, run_final_fraction);
-
-                // Go to next initial fraction
-                if (current_distrubution_nr < simulation_data.config->FRACTIONS) {
-                    SetNextInitalFraction();
-                }
+    // Every task steps one run for a while; a run is freed as soon as it has finished
+    int num_runs = static_cast<int>(parallel_simulations.size());
+    context->thread_pool->Run(num_runs, [&](int run) {
+        auto& simulation = parallel_simulations[run];
+        if (!simulation) return;
+        for (int step = 0; step < PARALLEL_STEPS_PER_UPDATE; ++step) {
+            simulation->Step(sf::seconds(Simulator::FIXED_TIME_STEP));
+            if ((parallel_run_results[run] = GetRunResult(*simulation))) {
+                simulation.reset(nullptr);
+                return;
             }
         }
+    });
+
+    int runs_finished = static_cast<int>(std::ranges::count_if(parallel_run_results, [](const auto& result) { return result.has_value(); }));
+    if (study_interface) {
+        std::string runNumberString = std::format("Run: {} of {}", current_run_nr + runs_finished, MaxRunsPerFraction());
+        study_interface->run_fld->text.setString(runNumberString);
+    }
+
+    // Log the results in run order once every run of the batch is done
+    if (runs_finished == num_runs) {
+        auto results = std::move(parallel_run_results);
+        parallel_simulations.clear();
+        parallel_run_results.clear();
+        for (auto& result : results) {
+            AddRunResult(*result);
+        }
+        if (IsFractionComplete()) FinishFraction();
+    }
+}
+
+std::optional<CompStudySimulator::RunResult> CompStudySimulator::GetRunResult(const CompSimulator &simulation) const {
+    std::array fraction = {0, 0};
+    for (int language_key : simulation.boids.language_key) {
+        fraction[language_key]++;
+    }
+
+    if (fraction[0] != 0 && fraction[1] != 0 && simulation.total_simulation_time < simulation_data.config->TIME_STEPS_PER_RUN) {
+        return std::nullopt;
+    }
+
+    int dominating_language_key = -1;
+    if (fraction[0] == 0) {
+        dominating_language_key = 1;
+    } else if (fraction[1] == 0) {
+        dominating_language_key = 0;
+    }
+    double time = std::min(static_cast<double>(simulation.total_simulation_time), static_cast<double>(simulation_data.config->TIME_STEPS_PER_RUN));
+    return RunResult{dominating_language_key, time, fraction};
+}
+
+void CompStudySimulator::AddRunResult(const RunResult &result) {
+    // Log the necessary data about the simulations outcome
+    run_outcomes.push_back(result.dominating_language_key);
+    run_final_fraction.push_back(result.final_fraction);
+    run_times.push_back(result.time);
+
+    // Get current system time
+    std::time_t current_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm* time_info = std::localtime(&current_time);
+
+    // Print the time in the format HH:MM:SS
+    std::cout << "["<<std::put_time(time_info, "%H:%M:%S") << "] Run Complete! Dominating Language: " << result.dominating_language_key
+              << ", Simulated time steps: " << result.time << std::endl;
+
+    current_run_nr++;
+}
+
+bool CompStudySimulator::IsAdaptive() const {
+    return simulation_data.config->CONFIDENCE_HALF_WIDTH > 0;
+}
+
+int CompStudySimulator::MaxRunsPerFraction() const {
+    // Fractions near the tipping point have the widest confidence interval, so they use the extra runs
+    if (IsAdaptive()) return ADAPTIVE_MAX_RUNS_FACTOR * simulation_data.config->RUNS_PER_FRACTION;
+    return simulation_data.config->RUNS_PER_FRACTION;
+}
+
+double CompStudySimulator::CalcConfidenceHalfWidth() const {
+    // Wilson score interval (95%) of the probability that language 0 dominates a run
+    if (run_outcomes.empty()) return 1;
+    constexpr double z = 1.96;
+    auto n = static_cast<double>(run_outcomes.size());
+    double p = static_cast<double>(std::ranges::count(run_outcomes, 0)) / n;
+    return z / (1 + z * z / n) * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n));
+}
+
+bool CompStudySimulator::IsFractionComplete() const {
+    if (current_run_nr >= MaxRunsPerFraction()) return true;
+    if (!IsAdaptive() || current_run_nr < ADAPTIVE_MIN_RUNS) return false;
+    return CalcConfidenceHalfWidth() <= simulation_data.config->CONFIDENCE_HALF_WIDTH;
+}
+
+void CompStudySimulator::FinishFraction() {
+    if (IsAdaptive()) {
+        std::cout << "Fraction " << current_distrubution_nr << " finished after " << current_run_nr
+                  << " runs, confidence interval half-width: " << CalcConfidenceHalfWidth() << std::endl;
+    }
+
+    // Check if the current initial fraction had a one-sided dominant outcome.
+    if (current_distrubution_nr != 0 && !run_outcomes.empty()) {
+        if (std::ranges::adjacent_find(run_outcomes, std::not_equal_to<>()) == run_outcomes.end() )
+        {
+            auto language_key = run_outcomes[0];
+            one_sided_outcome_found[language_key] = true;
+            std::cout << "one-sided dominanance found for language: " << language_key << std::endl;
+        }
+    }
+
+    // Log analysis data to the output file
+    LogDataToFile(output_file_path, current_distrubution_nr, current_initial_fraction, run_outcomes, run_times, run_final_fraction);
+
+    // Go to next initial fraction
+    if (current_distrubution_nr < simulation_data.config->FRACTIONS) {
+        SetNextInitalFraction();
     }
 }
 
@@ -4,6 +4,8 @@
 
 #ifndef DOMINANCESTUDY_H
 #define DOMINANCESTUDY_H
+#include <optional>
+
 #include "Application.h"
 #include "Camera.h"
 #include "SimulationData.h"
@@ -15,6 +17,20 @@
 
 class CompStudySimulator : public State {
 public:
+    // Outcome of a single finished run
+    struct RunResult {
+        int dominating_language_key;
+        double time;
+        std::array<int, 2> final_fraction;
+    };
+
+    // Steps every parallel run takes per Update, before the finished runs are collected
+    static constexpr int PARALLEL_STEPS_PER_UPDATE = 30;
+
+    // Adaptive study (config->CONFIDENCE_HALF_WIDTH > 0)
+    static constexpr int ADAPTIVE_MIN_RUNS = 10;
+    static constexpr int ADAPTIVE_MAX_RUNS_FACTOR = 2;
+
     std::shared_ptr<Context> context;
     Camera camera;
     KeySimulationData simulation_data;
@@ -26,6 +42,11 @@ public:
     std::map<int, int> current_initial_fraction;
     bool fast_analysis = false;
 
+    // Parallel runs: without display (or headless) the remaining runs of a fraction are simulated concurrently, each
+    // run single-threaded as one thread pool task. Results are stored per run and logged in run order.
+    std::vector<std::unique_ptr<CompSimulator>> parallel_simulations;
+    std::vector<std::optional<RunResult>> parallel_run_results;
+
     //Data logging
     std::vector<int> run_outcomes;
     std::vector<double> run_times;
@@ -47,6 +68,7 @@ public:
                               run_final_fractions);
 
     void Init() override;
+    bool IsFinished() const;
 
     void ShowDisplayDisabledMessage();
 
@@ -57,6 +79,18 @@ public:
     void SetNextInitalFraction();
 
     void Update(sf::Time delta_time) override;
+    bool UseParallelRuns() const;
+    void StartParallelRuns();
+    void UpdateParallelRuns();
+    std::optional<RunResult> GetRunResult(const CompSimulator& simulation) const;
+    void AddRunResult(const RunResult& result);
+
+    bool IsAdaptive() const;
+    int MaxRunsPerFraction() const;
+    double CalcConfidenceHalfWidth() const;
+    bool IsFractionComplete() const;
+    void FinishFraction();
+
     void Pause() override;
     void Draw() override;
     void Start() override;
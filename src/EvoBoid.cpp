@@ -2,53 +2,130 @@
 // Created by wouter on 28-2-2024.
 //
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <set>
+#include <unordered_map>
 
-#include "boid.h"
+#include "Boid.h"
+#include "FeatureCountGrid.h"
+#include "LanguageDistance.h"
 #include "World.h"
 #include "Utility.h"
 
-EvoBoid::EvoBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc, const std::shared_ptr<SimulationConfig> &config,
-                 Eigen::VectorXi language_vector, float language_influence, float perception_radius,
-                 float interaction_radius, float avoidance_radius, float collision_radius)
-    : Boid(std::move(pos), std::move(vel), std::move(acc), config, perception_radius, interaction_radius, avoidance_radius, collision_radius),
-      language_vector(std::move(language_vector)), language_influence(language_influence) {}
+EvoBoidStore::EvoBoidStore(const std::shared_ptr<SimulationConfig> &config, bool has_sprites)
+        : BoidStore(config, has_sprites), language_words((config->LANGUAGE_SIZE + 63) / 64), language_table(language_words) {
+}
+
+int EvoBoidStore::AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
+                          Eigen::VectorXi language_vector, float language_influence) {
+    int index = BoidStore::AddBoid(std::move(pos), std::move(vel), std::move(acc), sf::Color::Yellow);
+    language_bits.resize(language_bits.size() + language_words);
+    PackLanguageVector(index, language_vector);
+    language_id.push_back(language_table.Acquire(GetLanguageWords(index)));
+    this->language_influence.push_back(language_influence);
+    age.push_back(0);
+    return index;
+}
+
+int EvoBoidStore::AddBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
+                          std::span<const uint64_t> packed_language, float language_influence) {
+    int index = BoidStore::AddBoid(std::move(pos), std::move(vel), std::move(acc), sf::Color::Yellow);
+    language_bits.insert(language_bits.end(), packed_language.begin(), packed_language.begin() + language_words);
+    language_id.push_back(language_table.Acquire(GetLanguageWords(index)));
+    this->language_influence.push_back(language_influence);
+    age.push_back(0);
+    return index;
+}
+
+void EvoBoidStore::RemoveBoid(int index) {
+    // Same swap-remove as the other columns, but a whole stride of words at a time
+    int last = Size() - 1;
+    if (index != last) {
+        std::copy_n(language_bits.begin() + last * language_words, language_words, language_bits.begin() + index * language_words);
+    }
+    language_bits.resize(language_bits.size() - language_words);
+
+    language_table.Release(language_id[index]);
+    SwapRemove(language_id, index);
+    SwapRemove(language_influence, index);
+    SwapRemove(age, index);
+    BoidStore::RemoveBoid(index);
+}
 
-EvoBoid::EvoBoid(Eigen::Vector2f pos, Eigen::Vector2f vel, Eigen::Vector2f acc,
-    const std::shared_ptr<SimulationConfig> &config, Eigen::VectorXi language_vector, float language_influence)
-    : Boid(std::move(pos), std::move(vel), std::move(acc), config),
-      language_vector(std::move(language_vector)), language_influence(language_influence) {}
+void EvoBoidStore::PackLanguageVector(int index, const Eigen::VectorXi &language_vector) {
+    uint64_t* words = language_bits.data() + index * language_words;
+    std::fill_n(words, language_words, 0);
+    for (Eigen::Index f = 0; f < language_vector.size(); ++f) {
+        if (language_vector(f)) words[f / 64] |= uint64_t{1} << (f % 64);
+    }
+}
 
+void EvoBoidStore::SetLanguageVector(int index, const Eigen::VectorXi &language_vector) {
+    language_table.Release(language_id[index]);
+    PackLanguageVector(index, language_vector);
+    language_id[index] = language_table.Acquire(GetLanguageWords(index));
+}
+
+Eigen::VectorXi EvoBoidStore::GetLanguageVector(int index) const {
+    Eigen::VectorXi language_vector(config->LANGUAGE_SIZE);
+    for (int f = 0; f < config->LANGUAGE_SIZE; ++f) {
+        language_vector(f) = GetLanguageFeature(index, f);
+    }
+    return language_vector;
+}
+
+bool EvoBoidStore::GetLanguageFeature(int index, int feature_index) const {
+    return (language_bits[index * language_words + feature_index / 64] >> (feature_index % 64)) & 1;
+}
+
+std::span<const uint64_t> EvoBoidStore::GetLanguageWords(int index) const {
+    return {language_bits.data() + index * language_words, static_cast<size_t>(language_words)};
+}
+
+std::span<const uint64_t> EvoBoidStore::GetLanguageWords() const {
+    return language_bits;
+}
+
+const LanguageTable& EvoBoidStore::GetLanguageTable() const {
+    return language_table;
+}
 
-Eigen::Vector2f EvoBoid::GetUpdatedAcceleration(const std::vector<EvoBoid*> &interacting_boids, const Eigen::VectorXf& language_distances) const {
+int EvoBoidStore::CalcLanguageDifference(int index, int other_index) const {
+    return language_distance::CountDifferences(language_bits.data() + index * language_words,
+                                               language_bits.data() + other_index * language_words, language_words);
+}
+
+
+Eigen::Vector2f EvoBoidStore::GetUpdatedAcceleration(int index, const std::vector<int> &interacting_boids, const Eigen::VectorXf& language_distances) const {
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
     if (!interacting_boids.empty()) {
         //Coherence & Alignment
-        acceleration += CalcCoherenceAlignmentAcceleration(interacting_boids, language_distances);
+        acceleration += CalcCoherenceAlignmentAcceleration(index, interacting_boids, language_distances);
         //Avoidance
-        acceleration += CalcAvoidanceAcceleration(interacting_boids, language_distances);
+        acceleration += CalcAvoidanceAcceleration(index, interacting_boids, language_distances);
         //Separation
-        acceleration += CalcSeparationAcceleration(interacting_boids);
+        acceleration += CalcSeparationAcceleration(index, interacting_boids);
     }
     return acceleration;
 }
 
-void EvoBoid::UpdateAcceleration(const std::vector<EvoBoid*>& interacting_boids, const Eigen::VectorXf& language_distances) {
-    Eigen::Vector2f acceleration = GetUpdatedAcceleration(interacting_boids, language_distances);
-    SetAcceleration(acceleration);
+void EvoBoidStore::UpdateAcceleration(int index, const std::vector<int>& interacting_boids, const Eigen::VectorXf& language_distances) {
+    Eigen::Vector2f acceleration = GetUpdatedAcceleration(index, interacting_boids, language_distances);
+    SetAcceleration(index, acceleration);
 }
 
-void EvoBoid::UpdateLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids,
+void EvoBoidStore::UpdateLanguageFeatures(int index,
+                                        const std::vector<int> &interacting_boids,
                                         const Eigen::VectorXf& language_distances,
-                                        const std::vector<EvoBoid *> &perceived_boids,
+                                        const FeatureCountGrid &feature_counts,
                                         sf::Time delta_time) {
-    auto features = GetUpdatedLanguageFeatures(interacting_boids, language_distances, perceived_boids, delta_time);
-    SwitchLanguageFeatures(features);
+    auto features = GetUpdatedLanguageFeatures(index, interacting_boids, language_distances, feature_counts, delta_time);
+    SwitchLanguageFeatures(index, features);
 }
 
-float EvoBoid::CalcBehaviourModifier(const float language_distance) const {
+float EvoBoidStore::CalcBehaviourModifier(const float language_distance) const {
     float behaviour_modifier;
     float n = (language_distance - 0.5f)*2;
     if (language_distance >= 0.5) {
@@ -59,8 +136,8 @@ float EvoBoid::CalcBehaviourModifier(const float language_distance) const {
     return behaviour_modifier;
 }
 
-Eigen::Vector2f EvoBoid::CalcCoherenceAlignmentAcceleration(const std::vector<EvoBoid*> &interacting_boids,
-                                                               const Eigen::VectorXf &language_distances) const {
+Eigen::Vector2f EvoBoidStore::CalcCoherenceAlignmentAcceleration(int index, const std::vector<int> &interacting_boids,
+                                                                 const Eigen::VectorXf &language_distances) const {
 
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
     float total_modifier = 0;
@@ -75,14 +152,14 @@ Eigen::Vector2f EvoBoid::CalcCoherenceAlignmentAcceleration(const std::vector<Ev
         if (language_distance <= 0.5) {
             float modifier = CalcBehaviourModifier(language_distance);
             total_modifier += modifier;
-            avg_pos += interacting_boids[i]->pos * modifier;
-            avg_vel += interacting_boids[i]->vel * modifier;
+            avg_pos += pos[interacting_boids[i]] * modifier;
+            avg_vel += vel[interacting_boids[i]] * modifier;
         }
     }
 
     // account for own velocity and position (with modifier 1, logically)
-    avg_pos += this->pos;
-    avg_vel += this->vel;
+    avg_pos += pos[index];
+    avg_vel += vel[index];
     total_modifier += 1;
 
     // normalize all modifier weights by deviding with total_modifier weight.
@@ -91,81 +168,59 @@ Eigen::Vector2f EvoBoid::CalcCoherenceAlignmentAcceleration(const std::vector<Ev
         avg_vel = avg_vel / total_modifier;
 
         // COHERENCE
-        Eigen::Vector2f pos_difference = avg_pos - this->pos;
-        acceleration = pos_difference.normalized() * config->COHESION_FACTOR * max_speed;
+        Eigen::Vector2f pos_difference = avg_pos - pos[index];
+        acceleration = pos_difference.normalized() * config->COHESION_FACTOR * max_speed[index];
 
         // ALIGNMENT
-        Eigen::Vector2f vel_difference = avg_vel - this->vel;
-        acceleration += vel_difference.normalized() * config->ALIGNMENT_FACTOR * max_speed;
-    }
-
-    return acceleration;
-}
-
-
-Eigen::Vector2f EvoBoid::CalcSeparationAcceleration(const std::vector<EvoBoid*>& interacting_boids) const {
-
-    Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
-    float squared_separation_radius = separation_radius * separation_radius;
-
-    for (auto & boid : interacting_boids) {
-        Eigen::Vector2f pos_difference = boid->pos - this->pos;
-        float squared_distance = pos_difference.squaredNorm();
-        if (squared_distance <= squared_separation_radius) {
-            float strength = std::pow((squared_separation_radius - squared_distance) / squared_separation_radius, 2);
-            acceleration -= pos_difference.normalized() * max_speed * config->SEPARATION_FACTOR * (strength);
-        }
+        Eigen::Vector2f vel_difference = avg_vel - vel[index];
+        acceleration += vel_difference.normalized() * config->ALIGNMENT_FACTOR * max_speed[index];
     }
 
     return acceleration;
 }
 
-Eigen::Vector2f EvoBoid::CalcAvoidanceAcceleration(const std::vector<EvoBoid*>& interacting_boids, Eigen::VectorXf language_distances) const {
+Eigen::Vector2f EvoBoidStore::CalcAvoidanceAcceleration(int index, const std::vector<int>& interacting_boids, const Eigen::VectorXf &language_distances) const {
 
     Eigen::Vector2f acceleration = Eigen::Vector2f::Zero();
-    const float squared_interaction_radius = interaction_radius * interaction_radius;
 
     for (size_t i = 0; i < interacting_boids.size(); ++i) {
         const float& language_distance = language_distances(i);
         if (language_distance > 0.5) {
             float modifier = CalcBehaviourModifier(language_distance);
-            Eigen::Vector2f pos_difference = (interacting_boids[i]->pos - this->pos);
-            float squared_distance = pos_difference.squaredNorm();
-            acceleration -= pos_difference.normalized() * max_speed * modifier * config->AVOIDANCE_FACTOR;
+            Eigen::Vector2f pos_difference = (pos[interacting_boids[i]] - pos[index]);
+            acceleration -= pos_difference.normalized() * max_speed[index] * modifier * config->AVOIDANCE_FACTOR;
         }
     }
     return acceleration;
 }
 
-// Use Manhattan distance to calculate distance between vectors.
-Eigen::VectorXf EvoBoid::CalcLanguageDistances(const std::vector<EvoBoid*> &boids) const {
-    const size_t num_boids = boids.size();
+// Use Manhattan distance to calculate distance between vectors. The features are binary, so this is the number of
+// differing bits of the packed vectors.
+Eigen::VectorXf EvoBoidStore::CalcLanguageDistances(int index, const std::vector<int> &boids) const {
+    const int num_boids = static_cast<int>(boids.size());
     Eigen::VectorXf distances(num_boids);
 
-    for (Eigen::Index i = 0; i < num_boids; ++i) {
-        const Eigen::VectorXi& other_language = boids[i]->language_vector;
-        Eigen::VectorXf differences = (other_language - this->language_vector).cast<float>();
-        float language_distance = differences.cwiseAbs().sum() / static_cast<float>(config->LANGUAGE_SIZE);
-        distances[i] = language_distance;
+    // Gather the neighbours' languages into one contiguous block, so they can be compared in one batch
+    thread_local std::vector<uint64_t> neighbour_languages;
+    neighbour_languages.resize(boids.size() * language_words);
+    for (int i = 0; i < num_boids; ++i) {
+        std::ranges::copy(GetLanguageWords(boids[i]), neighbour_languages.begin() + i * language_words);
     }
+    language_distance::CalcBlockDistances(GetLanguageWords(index).data(), neighbour_languages.data(), num_boids,
+                                          language_words, static_cast<float>(config->LANGUAGE_SIZE), distances.data());
     return distances;
 }
 
-// Use Manhattan distance to calculate distance between vectors.
-Eigen::VectorXf EvoBoid::CalcLanguageDistances(const std::vector<std::shared_ptr<EvoBoid>> &boids) const {
-    const size_t num_boids = boids.size();
+// Distances to every boid in the store (including the boid itself).
+Eigen::VectorXf EvoBoidStore::CalcLanguageDistances(int index) const {
+    const int num_boids = Size();
     Eigen::VectorXf distances(num_boids);
-
-    for (Eigen::Index i = 0; i < num_boids; ++i) {
-        const Eigen::VectorXi& other_language = boids[i]->language_vector;
-        Eigen::VectorXf differences = (other_language - this->language_vector).cast<float>();
-        float language_distance = differences.cwiseAbs().sum() / static_cast<float>(config->LANGUAGE_SIZE);
-        distances[i] = language_distance;
-    }
+    language_distance::CalcBlockDistances(GetLanguageWords(index).data(), language_bits.data(), num_boids,
+                                          language_words, static_cast<float>(config->LANGUAGE_SIZE), distances.data());
     return distances;
 }
 
-int EvoBoid::CalcMutatedLanguageFeature(sf::Time delta_time) const {
+int EvoBoidStore::CalcMutatedLanguageFeature(sf::Time delta_time) const {
     auto r = GetRandomFloatBetween(0,1);
     int f_index = -1;
     if (r < config->MUTATION_RATE * delta_time.asSeconds()) {
@@ -174,23 +229,16 @@ int EvoBoid::CalcMutatedLanguageFeature(sf::Time delta_time) const {
     return f_index;
 }
 
-int CalcFeatureVariantOccurences(int variant, int feature_index, const std::vector<EvoBoid*> &perceived_boids) {
-    int occurences = 0;
-    for (auto& boid : perceived_boids) {
-        if (boid->language_vector(feature_index) == variant) occurences += 1;
-    }
-    return occurences;
-}
-
-std::set<int> EvoBoid::CalcAdoptedLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids,
-                                                      const Eigen::VectorXf& language_distances,
-                                                      const std::vector<EvoBoid *> &perceived_boids,
-                                                      sf::Time delta_time) {
+std::set<int> EvoBoidStore::CalcAdoptedLanguageFeatures(int index,
+                                                        const std::vector<int> &interacting_boids,
+                                                        const Eigen::VectorXf& language_distances,
+                                                        const FeatureCountGrid &feature_counts,
+                                                        sf::Time delta_time) const {
     std::set<int> adopted_features;
     int num_boids = interacting_boids.size();
     if (num_boids > 0) {
     int i = GetRandomIntBetween(0, num_boids-1);
-        auto boid = interacting_boids[i];
+        int boid = interacting_boids[i];
 
         float beta = config->BETA;
         float kappa = config->KAPPA;
@@ -202,10 +250,13 @@ std::set<int> EvoBoid::CalcAdoptedLanguageFeatures(const std::vector<EvoBoid *>
         if (r < interaction_probability * delta_time.asSeconds()) {
             // Choose a random feature of the boid that's being interacted with,
             int f_index = GetRandomIntBetween(0, config->LANGUAGE_SIZE - 1);
-            if (this->language_vector(f_index) != boid->language_vector(f_index)) {
+            bool boid_variant = GetLanguageFeature(boid, f_index);
+            if (GetLanguageFeature(index, f_index) != boid_variant) {
                 // Calculate the number of times the feature variant occures in the perceived area
-                int f_variant_occurences = CalcFeatureVariantOccurences(boid->language_vector(f_index), f_index, perceived_boids);
-                float p = config->MIN_ADOPTION_RATE + std::pow(f_variant_occurences/perceived_boids.size(), kappa-1);
+                int num_perceived_boids = feature_counts.CountBoids(perception_radius, index);
+                int f_set_occurences = feature_counts.CountFeatureSet(perception_radius, index, f_index, *this);
+                int f_variant_occurences = boid_variant ? f_set_occurences : num_perceived_boids - f_set_occurences;
+                float p = config->MIN_ADOPTION_RATE + std::pow(f_variant_occurences/num_perceived_boids, kappa-1);
                 float adoption_probability = std::min(1.f, p);
 
                 // Feature Adoption probability check
@@ -220,15 +271,16 @@ std::set<int> EvoBoid::CalcAdoptedLanguageFeatures(const std::vector<EvoBoid *>
     return adopted_features;
 }
 
-std::set<int> EvoBoid::GetUpdatedLanguageFeatures(const std::vector<EvoBoid *> &interacting_boids,
-                                                     const Eigen::VectorXf &language_distances,
-                                                     const std::vector<EvoBoid *> &perceived_boids,
-                                                     sf::Time delta_time) {
+std::set<int> EvoBoidStore::GetUpdatedLanguageFeatures(int index,
+                                                       const std::vector<int> &interacting_boids,
+                                                       const Eigen::VectorXf &language_distances,
+                                                       const FeatureCountGrid &feature_counts,
+                                                       sf::Time delta_time) const {
 
     std::set<int> updated_features;
-    if (age <= config->BOID_LIFE_STEPS / 2) {
+    if (age[index] <= config->BOID_LIFE_STEPS / 2) {
         // Get adopted features
-        updated_features = CalcAdoptedLanguageFeatures(interacting_boids, language_distances, perceived_boids, delta_time);
+        updated_features = CalcAdoptedLanguageFeatures(index, interacting_boids, language_distances, feature_counts, delta_time);
         // Get mutated feature
         int mutated_feauture = CalcMutatedLanguageFeature(delta_time);
         if (mutated_feauture != -1) updated_features.insert(mutated_feauture);
@@ -236,49 +288,56 @@ std::set<int> EvoBoid::GetUpdatedLanguageFeatures(const std::vector<EvoBoid *> &
     return updated_features;
 }
 
-void EvoBoid::SwitchLanguageFeatures(const std::set<int> &features) {
+void EvoBoidStore::SwitchLanguageFeatures(int index, const std::set<int> &features) {
+    if (features.empty()) return;
+
+    language_table.Release(language_id[index]);
     for (int f_index : features) {
-        language_vector(f_index) = !language_vector(f_index);
+        language_bits[index * language_words + f_index / 64] ^= uint64_t{1} << (f_index % 64);
     }
+    language_id[index] = language_table.Acquire(GetLanguageWords(index));
 }
 
-void EvoBoid::UpdateAge(sf::Time delta_time) {
-    age += delta_time.asSeconds();
+void EvoBoidStore::UpdateAge(int index, sf::Time delta_time) {
+    age[index] += delta_time.asSeconds();
 }
 
-Eigen::VectorXi EvoBoid::GetMostCommonLanguage(const std::vector<EvoBoid *> &boids) const {
-
-    std::unordered_map<Eigen::VectorXi, int, vectorXiHash, vectorXiEqual> language_counts;
+Eigen::VectorXi EvoBoidStore::GetMostCommonLanguage(int index, const std::vector<int> &boids) const {
 
-    // Count occurrences of each language vector
-    for (auto& boid : boids) {
-        language_counts[boid->language_vector] += 1;
+    // Count occurrences of each language (including the own language), by language id
+    std::unordered_map<int, int> language_counts;
+    for (int boid : boids) {
+        language_counts[language_id[boid]] += 1;
     }
+    language_counts[language_id[index]] += 1;
 
-    // Add own language
-    language_counts[this->language_vector] += 1;
-
-    // Find the language vector with the highest count
-    Eigen::VectorXi most_common_language;
+    // Find the language with the highest count
+    int most_common_language = language_id[index];
     int max_count = 0;
-    for (const auto& pair : language_counts) {
-        if (pair.second > max_count) {
-            max_count = pair.second;
-            most_common_language = pair.first;
+    for (const auto& [id, count] : language_counts) {
+        if (count > max_count) {
+            max_count = count;
+            most_common_language = id;
         }
     }
-    return most_common_language;
+
+    const auto words = language_table.GetWords(most_common_language);
+    Eigen::VectorXi language_vector(config->LANGUAGE_SIZE);
+    for (int f = 0; f < config->LANGUAGE_SIZE; ++f) {
+        language_vector(f) = (words[f / 64] >> (f % 64)) & 1;
+    }
+    return language_vector;
 }
 
-Eigen::Vector2f EvoBoid::GetOffspringPos(const World& world) {
+Eigen::Vector2f EvoBoidStore::GetOffspringPos(int index, const World& world) const {
 
     float angle = GetRandomFloatBetween(0, 2*std::numbers::pi);
-    float length = GetRandomFloatBetween(0, this->collision_radius);
-    float x = this->pos.x() + std::cos(angle) * length;
-    float y = this->pos.y() + std::sin(angle) * length;
+    float length = GetRandomFloatBetween(0, collision_radius);
+    float x = pos[index].x() + std::cos(angle) * length;
+    float y = pos[index].y() + std::sin(angle) * length;
 
     //Keep spawn position within world border (including buffer)
-    float buffer = this->collision_radius;
+    float buffer = collision_radius;
     x = std::max(std::min(x, world.width - buffer), buffer);
     y = std::max(std::min(y, world.height - buffer), buffer);
 
@@ -7,6 +7,7 @@
 #include <SFML/System/Time.hpp>
 #include <SFML/Window/Event.hpp>
 
+#include "Checkpoint.h"
 #include "Simulator.h"
 #include "Utility.h"
 
@@ -15,13 +16,19 @@
 EvoSimulator::EvoSimulator(std::shared_ptr<Context>& context, VectorSimulationData& simulation_data, std::string simulation_name,
                            float camera_width, float camera_height)
     : Simulator(context, simulation_data.config, simulation_data.world, camera_width, camera_height),
+      spatial_boid_grid(SpatialGrid(world.size().cast<int>(), static_cast<int>(config->INTERACTION_RADIUS))),
+      boids(config, !context->headless),
+      feature_count_grid(spatial_boid_grid),
       boid_spawners(simulation_data.boid_spawners),
-      num_threads(std::max(std::thread::hardware_concurrency() - 1.f, 1.f)),
-      spatial_boid_grid(SpatialGrid<EvoBoid>(world.size().cast<int>(), static_cast<int>(config->INTERACTION_RADIUS))),
-      output_file_path("output/" + simulation_name + "_output.txt") {
+      output_file_path("output/" + simulation_name + "_trajectory.bin"),
+      num_threads(context->thread_pool->Size()) {
+
+    checkpoint_file_path = "output/" + simulation_name + "_checkpoint.bin";
 
     // Create text for displaying the language of selecetd boid
-    selected_boid_language_display.setFont(*ResourceManager::GetFont("arial"));
+    if (const auto& p_font = ResourceManager::GetFont("arial")) {
+        selected_boid_language_display.setFont(*p_font);
+    }
     selected_boid_language_display.setCharacterSize(20);
     selected_boid_language_display.setFillColor(sf::Color::White);
     selected_boid_language_display.setPosition(10.f, 10.f);
@@ -36,25 +43,44 @@ void EvoSimulator::Init() {
     camera.FitWorld(world);
 
     // Spawn Boids
+    SeedRandomStream(SEQUENTIAL_STREAM);
     for (auto& spawner : boid_spawners) {
         spawner->AddBoids(world, config, boids);
     }
 
     // Initialize boids in spatial grid
-    for (auto& boid : boids) {
-        spatial_boid_grid.AddObj(boid);
-    }
+    spatial_boid_grid.Rebuild(boids.pos);
 
     //Create analyser for logging metrics
-    analyser = std::make_shared<EvoAnalyser>(boids);
-    analyser->SetLogTimeInterval(sf::seconds(config->ANALYSIS_LOG_INTERVAL));
+    analyser = std::make_unique<EvoAnalyser>(boids, output_file_path, sf::seconds(config->ANALYSIS_LOG_INTERVAL));
 };
 
 void EvoSimulator::Update(sf::Time delta_time) {
-    if (delta_time < sf::seconds(1 / 30.f)) {
-        delta_time = sf::seconds(1 / 30.f);
+    if (fast_forward) {
+        RunFastForwardTicks([this] { Step(sf::seconds(FIXED_TIME_STEP)); });
+    } else {
+        if (delta_time < sf::seconds(1 / 30.f)) {
+            delta_time = sf::seconds(1 / 30.f);
+        }
+        Step(delta_time);
     }
 
+    // Sprites only have to match the state that is drawn
+    boids.UpdateSprites();
+
+    // Update boids color if a boid is selected to compare with.
+    if (selected_boid) {
+        Eigen::VectorXf distances = boids.CalcLanguageDistances(boids.GetIndex(*selected_boid));
+        for (int i = 0; i < boids.Size(); ++i) {
+            boids.sprites[i].setColor(CalculateGradientColor(distances[i]));
+        }
+    }
+}
+
+void EvoSimulator::Step(sf::Time delta_time) {
+    // Deterministic runs cannot depend on the frame rate
+    if (IsDeterministic()) delta_time = sf::seconds(FIXED_TIME_STEP);
+
     if (config->MULTI_THREADING) {
         MultiThreadUpdate(delta_time);
     } else {
@@ -62,127 +88,103 @@ void EvoSimulator::Update(sf::Time delta_time) {
         context->state_manager->PopState();
     }
 
-    // Update boids color if a boid is selected to compare with.
-    if (selected_boid) {
-        Eigen::VectorXf distances = dynamic_cast<EvoBoid*>(selected_boid)->CalcLanguageDistances(boids);
-        for (int i = 0; i < boids.size(); ++i) {
-            boids[i]->sprite.setColor(CalculateGradientColor(distances[i]));
-        }
-    }
-
     // Save metrics
-    analyser->SaveMetricsToCSV(output_file_path, delta_time);
+    analyser->LogMetrics(delta_time);
+
+    // Increment simulation time
+    total_simulation_time += delta_time.asSeconds();
+    step_nr++;
 }
 
 void EvoSimulator::MultiThreadUpdate(sf::Time delta_time) {
-    std::vector<std::future<EvoSimulator::BoidValueMap>> future_pool;
-
-    // Launch threads, each thread handling a chunk of Boids
-    int elements_per_chunk = boids.size() / num_threads;
-    int start_indices[num_threads];
-    int end_indices[num_threads];
-    for (size_t i = 0; i < num_threads; ++i) {
-        start_indices[i] = elements_per_chunk * i;
-        end_indices[i] = elements_per_chunk * (i + 1);
-        if (i == num_threads - 1) {
-            end_indices[i] = boids.size();
-        }
-        //std::cout << start_indices[i] << "->" << end_indices[i] << std::endl;
-        int start_index = start_indices[i];
-        int end_index = end_indices[i];
-        future_pool.emplace_back(std::async(std::launch::async, [=]() {
-            return MultiThreadUpdateStepOne(start_index, end_index, delta_time);
-        }));
-    }
-
-    // Wait for all threads to finish
-    std::map<EvoBoid *, std::shared_ptr<BoidValues>> all_values;
-    for (auto& future : future_pool) {
-        auto partion = future.get();
-        std::lock_guard<std::mutex> lock(mtx);
-        // Collect partions and add them together
-        all_values.insert(partion.begin(), partion.end());
-    }
+    // Feature counts of the current grid and languages, read by the language updates of every boid
+    feature_count_grid.Rebuild(boids);
+
+    // Divide the boids (in grid cell order) into chunks with a similar amount of work. Threads keep taking the
+    // next chunk from the thread pool, which returns once all chunks are done.
+    updated_boid_values.resize(boids.Size());
+    int num_chunks = static_cast<int>(num_threads) * WORK_CHUNKS_PER_THREAD;
+    spatial_boid_grid.CreateWorkChunks(num_chunks, work_chunk_start);
+    std::span<const int> cell_ordered_boids(spatial_boid_grid.cell_boids);
+    context->thread_pool->Run(num_chunks, [&](int chunk) {
+        auto chunk_boids = cell_ordered_boids.subspan(work_chunk_start[chunk], work_chunk_start[chunk + 1] - work_chunk_start[chunk]);
+        MultiThreadUpdateStepOne(chunk_boids, delta_time, updated_boid_values);
+    });
 
     //Set updated accelration and language features
-    for (auto& boid : boids) {
-        boid->SetAcceleration(all_values[boid.get()]->acceleration_value);
-        boid->SwitchLanguageFeatures(all_values[boid.get()]->language_features);
+    for (int i = 0; i < boids.Size(); ++i) {
+        boids.SetAcceleration(i, updated_boid_values[i].acceleration_value);
+        boids.SwitchLanguageFeatures(i, updated_boid_values[i].language_features);
     }
 
     UpdateBoidsStepTwo(delta_time);
 
     //Handle boids life and death cycle
-    RemoveDeadBoidsAndAddOffspring(all_values);
+    SeedRandomStream(SEQUENTIAL_STREAM);
+    RemoveDeadBoidsAndAddOffspring(updated_boid_values);
 }
 
-EvoSimulator::BoidValueMap EvoSimulator::MultiThreadUpdateStepOne(
-    int start_index, int end_index, sf::Time delta_time) const {
+void EvoSimulator::MultiThreadUpdateStepOne(std::span<const int> boid_indices, sf::Time delta_time,
+                                            std::vector<BoidValues> &boid_values) const {
 
-    //UpdatedBoidValues boid_values;
-    BoidValueMap UpdatedBoidValuesPerBoid;
+    // Per-thread neighbour buffers, reused for every boid so the search does not allocate in steady state
+    thread_local std::vector<int> interacting_boids;
 
-    for (int i = start_index; i < end_index; ++i) {
-        std::vector<EvoBoid*> interacting_boids = spatial_boid_grid.ObjRadiusSearch(boids[i]->interaction_radius, boids[i]);
-        std::vector<EvoBoid*> perceived_boids = spatial_boid_grid.ObjRadiusSearch(boids[i]->perception_radius, boids[i]);
-        Eigen::VectorXf language_distances = boids[i]->CalcLanguageDistances(interacting_boids);
+    // Every boid is in exactly one chunk, so each thread only writes to the slots of its own boids
+    for (int i : boid_indices) {
+        SeedRandomStream(i);
 
+        // Perceived boids are only needed for feature counts, which come from the feature count grid
+        spatial_boid_grid.ObjRadiusSearch(boids.interaction_radius, i, interacting_boids);
+        Eigen::VectorXf language_distances = boids.CalcLanguageDistances(i, interacting_boids);
 
-        auto boidValuesPtr = std::make_shared<BoidValues>();
-        boidValuesPtr->acceleration_value = (boids[i]->GetUpdatedAcceleration(interacting_boids, language_distances));
-        boidValuesPtr->language_features = (boids[i]->GetUpdatedLanguageFeatures(interacting_boids,
-                                                                                   language_distances,
-                                                                                   perceived_boids,
-                                                                                   delta_time));
+        BoidValues& values = boid_values[i];
+        values.acceleration_value = boids.GetUpdatedAcceleration(i, interacting_boids, language_distances);
+        values.language_features = boids.GetUpdatedLanguageFeatures(i,
+                                                                    interacting_boids,
+                                                                    language_distances,
+                                                                    feature_count_grid,
+                                                                    delta_time);
+        values.marked_for_death = false;
 
-        if (boids[i]->age >= config->BOID_LIFE_STEPS) {
+        if (boids.age[i] >= config->BOID_LIFE_STEPS) {
             float r = GetRandomFloatBetween(0,1);
             if (r <= 0.01 * delta_time.asSeconds()) {
-                boidValuesPtr->marked_for_death = true;
-                //boidValuesPtr->most_common_language = boids[i]->GetMostCommonLanguage(interacting_boids);
+                values.marked_for_death = true;
+                //values.most_common_language = boids.GetMostCommonLanguage(i, interacting_boids);
                 if (interacting_boids.size() > 0) {
                     r = GetRandomIntBetween(0,interacting_boids.size()-1);
-                    boidValuesPtr->most_common_language = interacting_boids[r]->language_vector;
+                    values.most_common_language = boids.GetLanguageVector(interacting_boids[r]);
                 } else {
-                    boidValuesPtr->most_common_language = boids[i]->language_vector;
+                    values.most_common_language = boids.GetLanguageVector(i);
                 }
             }
         }
-
-        // Insert the unique_ptr into the map
-        UpdatedBoidValuesPerBoid[boids[i].get()] = boidValuesPtr;
     }
-
-    return UpdatedBoidValuesPerBoid;
-    // return boid_values;
 }
 
 
 void EvoSimulator::UpdateBoidsStepTwo(sf::Time delta_time) {
-    for (const auto& boid : boids) {
+    for (int i = 0; i < boids.Size(); ++i) {
 
         //Update boid behaviour based on terrain effects
         bool in_terrain = false;
         for (auto& terrain : world.terrains) {
-            if (terrain->IsPointInside(boid->pos)) {
-                terrain->ApplyMovementEffects(boid.get());
+            if (terrain->IsPointInside(boids.pos[i])) {
+                terrain->ApplyMovementEffects(boids, i);
                 in_terrain = true;
             }
         }
-        if (!in_terrain) boid->SetDefaultMinMaxSpeed();
+        if (!in_terrain) boids.SetDefaultMinMaxSpeed(i);
 
         //Update boids velocity (Also checking Collisions)
-        boid->UpdateVelocity(world.obstacles, delta_time);
+        boids.UpdateVelocity(i, world.obstacles, delta_time);
 
         //Update boids position
-        boid->UpdatePosition(delta_time);
-        spatial_boid_grid.UpdateObj(boid);
+        boids.UpdatePosition(i, delta_time);
 
         //Update boids age
-        boid->age += delta_time.asSeconds();
-
-        //Update boids sprite
-        boid->UpdateSprite();
+        boids.UpdateAge(i, delta_time);
     }
 }
 
@@ -198,9 +200,9 @@ void EvoSimulator::ProcessInput() {
         if (event.type == sf::Event::MouseButtonPressed) {
             if (event.mouseButton.button == sf::Mouse::Left) {
                 //Boid Selection
-                ProcessBoidSelection(context.get(), mouse_pos, spatial_boid_grid);
+                ProcessBoidSelection(context.get(), mouse_pos, spatial_boid_grid, boids);
                 if (!selected_boid) {
-                    for (auto& boid : boids) { boid->sprite.setColor(sf::Color::Yellow);}
+                    for (auto& sprite : boids.sprites) { sprite.setColor(sf::Color::Yellow);}
                 }
             }
             if (event.mouseButton.button == sf::Mouse::Middle) {
@@ -230,12 +232,21 @@ void EvoSimulator::ProcessInput() {
             context->state_manager->PopState();
         }
 
+        if (IsKeyPressedOnce(sf::Keyboard::F)) {
+            fast_forward = !fast_forward;
+            std::cout << "Fast-forward Simulation: " << fast_forward << std::endl;
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::F6)) {
+            if (checkpoint::SaveCheckpoint(checkpoint_file_path, *this)) std::cout << "Saved Checkpoint to:" << checkpoint_file_path << std::endl;
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::F9)) {
+            if (checkpoint::LoadCheckpoint(checkpoint_file_path, *this)) std::cout << "Loaded Checkpoint:" << checkpoint_file_path << std::endl;
+        }
+
         if (IsKeyPressedOnce(sf::Keyboard::Space)) {
-            std::unordered_map<Eigen::VectorXi, int, vectorXiHash, vectorXiEqual> language_counts;
-            for (auto& boid : boids) {
-                language_counts[boid->language_vector] += 1;
-            }
-            std::cout << "different languages globaly:" << language_counts.size() << std::endl;
+            std::cout << "different languages globaly:" << boids.GetLanguageTable().NumLanguages() << std::endl;
         }
     }
     camera.Drag(mouse_pos);
@@ -254,8 +265,8 @@ void EvoSimulator::DrawWorldAndBoids() {
     spatial_boid_grid.DrawGrid(context->window.get());
 
     // Draw Boids
-    for (const auto& boid : boids) {
-        context->window->draw(boid->sprite);
+    for (const auto& sprite : boids.sprites) {
+        context->window->draw(sprite);
     }
 
     // Draw Obstacles
@@ -264,7 +275,7 @@ void EvoSimulator::DrawWorldAndBoids() {
     }
 
     // Draw Boid Selection Circle
-    DrawBoidSelectionCircle();
+    DrawBoidSelectionCircle(boids);
 
     // Reset camera view to default
     context->window->setView(context->window->getDefaultView());
@@ -288,9 +299,10 @@ void EvoSimulator::Draw() {
     DrawWorldAndBoids();
 
     if (selected_boid) {
+        int index = boids.GetIndex(*selected_boid);
         std::stringstream ss;
-        ss << "Boid Language: [" << dynamic_cast<EvoBoid*>(selected_boid)->language_vector.transpose() << "]";
-        ss << "\nAge: " << static_cast<int>(dynamic_cast<EvoBoid*>(selected_boid)->age);
+        ss << "Boid Language: [" << boids.GetLanguageVector(index).transpose() << "]";
+        ss << "\nAge: " << static_cast<int>(boids.age[index]);
         selected_boid_language_display.setString(ss.str());
         context->window->draw(selected_boid_language_display);
     }
@@ -307,43 +319,34 @@ void EvoSimulator::Pause() {
 
 };
 
-void EvoSimulator::AddBoid(const std::shared_ptr<EvoBoid> &boid) {
-    boids.push_back(boid);           // creates a copy of shared_ptr, assigning an additional owner (boids)
-    spatial_boid_grid.AddObj(boid);
-}
+void EvoSimulator::RemoveDeadBoidsAndAddOffspring(const std::vector<BoidValues> &boid_values) {
 
-void EvoSimulator::RemoveDeadBoidsAndAddOffspring(BoidValueMap updated_boid_values) {
+    std::vector<std::pair<Eigen::Vector2f, Eigen::VectorXi>> offspring_boids;
 
-    std::vector<std::shared_ptr<EvoBoid>> offspring_boids;
-
-    // Iterate through the boids and remove the ones marked for death, while also collecting offsprinf
-    for (auto it = boids.begin(); it != boids.end();) {
-        auto boidPtr = it->get();
-        if (updated_boid_values[boidPtr]->marked_for_death) {
+    // Iterate back to front through the boids and remove the ones marked for death, while also collecting offspring.
+    // Removing a boid moves the last boid into its index, which has then already been visited.
+    for (int i = boids.Size() - 1; i >= 0; --i) {
+        if (boid_values[i].marked_for_death) {
 
             // Add one offspring boid
-            auto offspring_spawn_point = boidPtr->GetOffspringPos(world);
-            auto new_boid = std::make_shared<EvoBoid>(offspring_spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), config,
-                                                         updated_boid_values[boidPtr]->most_common_language, 1);
-            offspring_boids.emplace_back(std::move(new_boid));
+            auto offspring_spawn_point = boids.GetOffspringPos(i, world);
+            offspring_boids.emplace_back(offspring_spawn_point, boid_values[i].most_common_language);
 
             // Remove dead boid
-            spatial_boid_grid.RemoveObj(*it);
-            it = boids.erase(it);
-            if (boidPtr == selected_boid) {
-                selected_boid = nullptr;
-                for (auto& boid : boids) { boid->sprite.setColor(sf::Color::Yellow);}
+            bool was_selected = selected_boid && boids.GetIndex(*selected_boid) == i;
+            boids.RemoveBoid(i);
+            if (was_selected) {
+                selected_boid.reset();
+                for (auto& sprite : boids.sprites) { sprite.setColor(sf::Color::Yellow);}
             }
-
-        } else {
-            ++it;
         }
     }
 
-    // Add new offspring boids to boids vector and grid
-    for (auto& boid :offspring_boids) {
-        boids.push_back(boid);
-        spatial_boid_grid.AddObj(boid);
+    // Add new offspring boids to the boid store
+    for (auto& [spawn_point, language_vector] : offspring_boids) {
+        boids.AddBoid(spawn_point, Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), language_vector, 1);
     }
-}
 
+    // Re-sort the spatial grid for the next update
+    spatial_boid_grid.Rebuild(boids.pos);
+}
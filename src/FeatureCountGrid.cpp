@@ -0,0 +1,42 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "FeatureCountGrid.h"
+
+#include <bit>
+
+#include "Boid.h"
+#include "SpatialGrid.tpp"
+
+FeatureCountGrid::FeatureCountGrid(const SpatialGrid &grid) : grid(grid) {
+}
+
+void FeatureCountGrid::Rebuild(const EvoBoidStore &boids) {
+    language_size = boids.config->LANGUAGE_SIZE;
+    feature_counts.assign(static_cast<size_t>(grid.max_possible_key + 1) * language_size, 0);
+
+    for (int i = 0; i < boids.Size(); ++i) {
+        int* cell_counts = feature_counts.data() + grid.boid_keys[i] * language_size;
+
+        // Only visit the set bits of the packed language vector
+        std::span<const uint64_t> words = boids.GetLanguageWords(i);
+        for (size_t w = 0; w < words.size(); ++w) {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                cell_counts[w * 64 + std::countr_zero(bits)]++;
+            }
+        }
+    }
+}
+
+int FeatureCountGrid::CountBoids(float radius, int index) const {
+    return grid.CountObjInRadius(radius, index,
+                                 [this](int key) { return grid.cell_start[key + 1] - grid.cell_start[key]; },
+                                 [](int) { return 1; });
+}
+
+int FeatureCountGrid::CountFeatureSet(float radius, int index, int feature_index, const EvoBoidStore &boids) const {
+    return grid.CountObjInRadius(radius, index,
+                                 [&](int key) { return feature_counts[key * language_size + feature_index]; },
+                                 [&](int other_index) { return static_cast<int>(boids.GetLanguageFeature(other_index, feature_index)); });
+}
@@ -0,0 +1,36 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef FEATURECOUNTGRID_H
+#define FEATURECOUNTGRID_H
+
+#include <vector>
+
+#include "SpatialGrid.h"
+
+class EvoBoidStore;
+
+// Per grid cell histograms of the language features: for every cell of the spatial grid, the number of boids in it
+// that have each feature set. Counting a feature variant around a boid then sums the histograms of the cells inside
+// the radius, and only the boids in cells crossing the edge of the radius are checked one by one.
+class FeatureCountGrid {
+public:
+    explicit FeatureCountGrid(const SpatialGrid& grid);
+
+    // Recount the histograms. Must be called after the spatial grid was rebuilt or language features changed.
+    void Rebuild(const EvoBoidStore &boids);
+
+    // Number of other boids within the radius of boid 'index'
+    int CountBoids(float radius, int index) const;
+    // Number of other boids within the radius of boid 'index' that have feature 'feature_index' set. The number without
+    // it is CountBoids minus this count.
+    int CountFeatureSet(float radius, int index, int feature_index, const EvoBoidStore &boids) const;
+
+private:
+    const SpatialGrid& grid;
+    int language_size = 0;
+    std::vector<int> feature_counts;    // feature_counts[key * language_size + feature]
+};
+
+#endif //FEATURECOUNTGRID_H
@@ -0,0 +1,122 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "HeadlessRunner.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <set>
+
+#include "Checkpoint.h"
+#include "CompStudySimulator.h"
+#include "MainMenu.h"
+#include "Serialization.h"
+#include "Simulator.h"
+
+HeadlessRunner::HeadlessRunner(std::string scenario_file, float run_time, std::string resume_checkpoint)
+    : scenario_file(std::move(scenario_file)), run_time(run_time), resume_checkpoint(std::move(resume_checkpoint)),
+      context(std::make_shared<Context>(true)) {
+    simulation_name = std::filesystem::path(this->scenario_file).stem().string();
+}
+
+int HeadlessRunner::Run() {
+    auto loaded_data = serialization::LoadSimulationDataFromFile(scenario_file);
+    if (!loaded_data) {
+        std::cerr << "Error: Something wrong, cannot open file! " << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Create the output directory if it doesn't exist
+    if (!std::filesystem::exists("output/"))
+        std::filesystem::create_directory("output/");
+
+    auto start_time = std::chrono::steady_clock::now();
+    int result = EXIT_FAILURE;
+    switch (loaded_data->type) {
+        case CompSimulation:
+            result = RunCompSimulation(MainMenu::load_key_simulation_data(loaded_data));
+            break;
+        case EvoSimulation:
+            result = RunEvoSimulation(MainMenu::load_vector_simulation_data(loaded_data));
+            break;
+        case CompStudy:
+            result = RunCompStudy(MainMenu::load_key_simulation_data(loaded_data));
+            break;
+    }
+
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Headless run of " << simulation_name << " finished in " << wall_time.count() << "s" << std::endl;
+    return result;
+}
+
+int HeadlessRunner::RunCompSimulation(KeySimulationData simulation_data) {
+    CompSimulator simulation(context, simulation_data, simulation_name, 1600, 900);
+    simulation.EnableTrajectoryOutput();
+    simulation.Init();
+    if (!resume_checkpoint.empty() && !checkpoint::LoadCheckpoint(resume_checkpoint, simulation)) return EXIT_FAILURE;
+
+    // Run until the time limit, or until only one language is left
+    const sf::Time time_step = sf::seconds(Simulator::FIXED_TIME_STEP);
+    float next_checkpoint_time = simulation.total_simulation_time + CHECKPOINT_INTERVAL;
+    while (run_time <= 0 || simulation.total_simulation_time < run_time) {
+        simulation.Update(time_step);
+
+        if (simulation.total_simulation_time >= next_checkpoint_time) {
+            checkpoint::SaveCheckpoint(simulation.checkpoint_file_path, simulation);
+            next_checkpoint_time += CHECKPOINT_INTERVAL;
+        }
+
+        std::set<int> languages(simulation.boids.language_key.begin(), simulation.boids.language_key.end());
+        if (languages.size() <= 1) break;
+    }
+
+    std::cout << "Simulated time: " << simulation.total_simulation_time << "s" << std::endl;
+    if (simulation.analyser) {
+        simulation.analyser->SaveBoidPerLanguageToCSV(simulation.output_file_path + "_language_output.txt");
+    }
+    return EXIT_SUCCESS;
+}
+
+int HeadlessRunner::RunEvoSimulation(VectorSimulationData simulation_data) {
+    if (run_time <= 0) {
+        std::cerr << "Error: Evolution simulations do not terminate, a run time is required." << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!simulation_data.config->MULTI_THREADING) {
+        std::cerr << "Error: Evolution Simulator only supported with MULTI_THREADING enabled, for now." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    EvoSimulator simulation(context, simulation_data, simulation_name, 1600, 900);
+    simulation.Init();
+    if (!resume_checkpoint.empty() && !checkpoint::LoadCheckpoint(resume_checkpoint, simulation)) return EXIT_FAILURE;
+
+    // The analyser streams its trajectory file while updating
+    const sf::Time time_step = sf::seconds(Simulator::FIXED_TIME_STEP);
+    float next_checkpoint_time = simulation.total_simulation_time + CHECKPOINT_INTERVAL;
+    while (simulation.total_simulation_time < run_time) {
+        simulation.Update(time_step);
+
+        if (simulation.total_simulation_time >= next_checkpoint_time) {
+            checkpoint::SaveCheckpoint(simulation.checkpoint_file_path, simulation);
+            next_checkpoint_time += CHECKPOINT_INTERVAL;
+        }
+    }
+
+    std::cout << "Simulated time: " << simulation.total_simulation_time << "s" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int HeadlessRunner::RunCompStudy(KeySimulationData simulation_data) {
+    // Every run ends after TIME_STEPS_PER_RUN or when a language dies out, the study logs each fraction to its output file
+    CompStudySimulator study(context, simulation_data, simulation_name, 1600, 900);
+    study.SetupCurrentFraction(study.current_distrubution_nr);
+
+    const sf::Time time_step = sf::seconds(Simulator::FIXED_TIME_STEP);
+    while (!study.IsFinished()) {
+        study.Update(time_step);
+    }
+    return EXIT_SUCCESS;
+}
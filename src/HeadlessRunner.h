@@ -0,0 +1,38 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <memory>
+#include <string>
+
+#include "Application.h"
+#include "SimulationData.h"
+
+// Runs a saved scenario without window, textures or sprites, as fast as possible, writing the usual output files.
+// Simulations save a checkpoint every CHECKPOINT_INTERVAL simulated seconds, and can resume from a checkpoint.
+// Usage: Thesis_run --headless <scenario file> [simulated seconds] [checkpoint to resume from]
+class HeadlessRunner {
+public:
+    static constexpr float CHECKPOINT_INTERVAL = 60.f;
+
+    HeadlessRunner(std::string scenario_file, float run_time, std::string resume_checkpoint = "");
+
+    // Returns the process exit code.
+    int Run();
+
+private:
+    std::string scenario_file;
+    std::string simulation_name;
+    float run_time;     // simulated seconds, 0 = until the run terminates by itself (not for evolution simulations)
+    std::string resume_checkpoint;
+    std::shared_ptr<Context> context;
+
+    int RunCompSimulation(KeySimulationData simulation_data);
+    int RunEvoSimulation(VectorSimulationData simulation_data);
+    int RunCompStudy(KeySimulationData simulation_data);
+};
+
+#endif //HEADLESSRUNNER_H
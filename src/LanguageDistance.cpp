@@ -0,0 +1,113 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "LanguageDistance.h"
+
+#include <bit>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LANGUAGE_DISTANCE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+    // WORDS is the word count known at compile time (fully unrolled loop), WORDS == 0 is the fallback for any other
+    // language size.
+    template<int WORDS>
+    int CountDifferences(const uint64_t* words, const uint64_t* other_words, int num_words) {
+        int difference = 0;
+        if constexpr (WORDS > 0) {
+            for (int w = 0; w < WORDS; ++w) difference += std::popcount(words[w] ^ other_words[w]);
+        } else {
+            for (int w = 0; w < num_words; ++w) difference += std::popcount(words[w] ^ other_words[w]);
+        }
+        return difference;
+    }
+
+    template<int WORDS>
+    void CalcBlockDistances(const uint64_t* query, const uint64_t* block, int num_languages, int num_words,
+                            float language_size, float* distances) {
+        for (int i = 0; i < num_languages; ++i) {
+            int difference = CountDifferences<WORDS>(query, block + i * num_words, num_words);
+            distances[i] = static_cast<float>(difference) / language_size;
+        }
+    }
+
+#ifdef LANGUAGE_DISTANCE_X86_SIMD
+    // Single word languages, 8 per iteration. Divides (instead of multiplying by the reciprocal) like the scalar kernel.
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    int CalcSingleWordDistancesAVX512(uint64_t query, const uint64_t* block, int num_languages, float language_size, float* distances) {
+        const __m512i query_words = _mm512_set1_epi64(static_cast<long long>(query));
+        const __m256 divisor = _mm256_set1_ps(language_size);
+        int i = 0;
+        for (; i + 8 <= num_languages; i += 8) {
+            __m512i differences = _mm512_xor_si512(_mm512_loadu_si512(block + i), query_words);
+            __m256i counts = _mm512_cvtepi64_epi32(_mm512_popcnt_epi64(differences));
+            _mm256_storeu_ps(distances + i, _mm256_div_ps(_mm256_cvtepi32_ps(counts), divisor));
+        }
+        return i;
+    }
+
+    // Single word languages, 4 per iteration. Bytes are counted with a nibble lookup table and summed per word.
+    __attribute__((target("avx2")))
+    int CalcSingleWordDistancesAVX2(uint64_t query, const uint64_t* block, int num_languages, float language_size, float* distances) {
+        const __m256i query_words = _mm256_set1_epi64x(static_cast<long long>(query));
+        const __m256i nibble_counts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+        const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        const __m128 divisor = _mm_set1_ps(language_size);
+        int i = 0;
+        for (; i + 4 <= num_languages; i += 4) {
+            __m256i differences = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i)), query_words);
+            __m256i low = _mm256_and_si256(differences, low_nibbles);
+            __m256i high = _mm256_and_si256(_mm256_srli_epi16(differences, 4), low_nibbles);
+            __m256i byte_counts = _mm256_add_epi8(_mm256_shuffle_epi8(nibble_counts, low), _mm256_shuffle_epi8(nibble_counts, high));
+            __m256i word_counts = _mm256_sad_epu8(byte_counts, _mm256_setzero_si256());
+            __m128i counts = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(word_counts, low_halves));
+            _mm_storeu_ps(distances + i, _mm_div_ps(_mm_cvtepi32_ps(counts), divisor));
+        }
+        return i;
+    }
+
+    enum class SimdLevel { None, AVX2, AVX512 };
+
+    SimdLevel GetSimdLevel() {
+        static const SimdLevel level = [] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) return SimdLevel::AVX512;
+            if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+            return SimdLevel::None;
+        }();
+        return level;
+    }
+#endif
+}
+
+int language_distance::CountDifferences(const uint64_t* language, const uint64_t* other_language, int num_words) {
+    return ::CountDifferences<0>(language, other_language, num_words);
+}
+
+void language_distance::CalcBlockDistances(const uint64_t* query, const uint64_t* block, int num_languages, int num_words,
+                                           float language_size, float* distances) {
+    switch (num_words) {
+        case 1: {
+            int done = 0;
+#ifdef LANGUAGE_DISTANCE_X86_SIMD
+            switch (GetSimdLevel()) {
+                case SimdLevel::AVX512: done = CalcSingleWordDistancesAVX512(*query, block, num_languages, language_size, distances); break;
+                case SimdLevel::AVX2: done = CalcSingleWordDistancesAVX2(*query, block, num_languages, language_size, distances); break;
+                case SimdLevel::None: break;
+            }
+#endif
+            // Remaining languages that do not fill a vector register
+            ::CalcBlockDistances<1>(query, block + done, num_languages - done, 1, language_size, distances + done);
+            break;
+        }
+        // Up to 128 and 256 features
+        case 2: ::CalcBlockDistances<2>(query, block, num_languages, num_words, language_size, distances); break;
+        case 4: ::CalcBlockDistances<4>(query, block, num_languages, num_words, language_size, distances); break;
+        default: ::CalcBlockDistances<0>(query, block, num_languages, num_words, language_size, distances); break;
+    }
+}
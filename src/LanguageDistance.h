@@ -0,0 +1,23 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef LANGUAGEDISTANCE_H
+#define LANGUAGEDISTANCE_H
+
+#include <cstdint>
+
+// Manhattan distances between bit-packed language vectors (see EvoBoidStore): the number of differing bits, divided by
+// the language size. Languages of up to 64 features (one word) are handled with AVX-512 or AVX2 when the processor
+// supports it, the other sizes and processors use the scalar kernels. All paths give identical results.
+namespace language_distance {
+    // Number of differing features of two packed languages of 'num_words' words
+    int CountDifferences(const uint64_t* language, const uint64_t* other_language, int num_words);
+
+    // distances[i] = distance between 'query' and language i of 'block', which holds 'num_languages' packed languages
+    // of 'num_words' words each, one after the other.
+    void CalcBlockDistances(const uint64_t* query, const uint64_t* block, int num_languages, int num_words,
+                            float language_size, float* distances);
+};
+
+#endif //LANGUAGEDISTANCE_H
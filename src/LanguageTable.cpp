@@ -0,0 +1,77 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "LanguageTable.h"
+
+#include <algorithm>
+
+LanguageTable::LanguageTable(int num_words) : num_words(num_words) {
+}
+
+size_t LanguageTable::Hash(std::span<const uint64_t> language_words) {
+    // splitmix64 finalizer over the words
+    uint64_t hash = language_words.size();
+    for (uint64_t word : language_words) {
+        hash ^= word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+    }
+    return static_cast<size_t>(hash);
+}
+
+int LanguageTable::Acquire(std::span<const uint64_t> language_words) {
+    size_t hash = Hash(language_words);
+    auto [first, last] = ids_by_hash.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (std::ranges::equal(GetWords(it->second), language_words)) {
+            counts[it->second]++;
+            return it->second;
+        }
+    }
+
+    // Language nobody speaks yet
+    int id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = static_cast<int>(counts.size());
+        words.resize(words.size() + num_words);
+        counts.push_back(0);
+        hashes.push_back(0);
+    }
+    std::ranges::copy(language_words, words.begin() + id * num_words);
+    counts[id] = 1;
+    hashes[id] = hash;
+    ids_by_hash.emplace(hash, id);
+    num_languages++;
+    return id;
+}
+
+void LanguageTable::Release(int id) {
+    if (--counts[id] > 0) return;
+
+    auto [first, last] = ids_by_hash.equal_range(hashes[id]);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == id) {
+            ids_by_hash.erase(it);
+            break;
+        }
+    }
+    free_ids.push_back(id);
+    num_languages--;
+}
+
+std::span<const uint64_t> LanguageTable::GetWords(int id) const {
+    return {words.data() + id * num_words, static_cast<size_t>(num_words)};
+}
+
+int LanguageTable::GetCount(int id) const {
+    return counts[id];
+}
+
+int LanguageTable::NumLanguages() const {
+    return num_languages;
+}
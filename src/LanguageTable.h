@@ -0,0 +1,44 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef LANGUAGETABLE_H
+#define LANGUAGETABLE_H
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Interned packed language vectors. Every distinct language gets an id and a count of the boids that speak it, so
+// population level statistics (number of distinct languages, most common language) do not have to compare vectors.
+// Ids of languages that are no longer spoken are reused.
+class LanguageTable {
+public:
+    explicit LanguageTable(int num_words);
+
+    // Id of the language, registering one more speaker (a new id for a language nobody speaks yet)
+    int Acquire(std::span<const uint64_t> language_words);
+    // Registers one speaker less. The id is freed once nobody speaks the language anymore.
+    void Release(int id);
+
+    std::span<const uint64_t> GetWords(int id) const;
+    int GetCount(int id) const;
+    int NumLanguages() const;   // distinct languages with at least one speaker
+
+private:
+    int num_words;
+    int num_languages = 0;
+
+    // Indexed by id
+    std::vector<uint64_t> words;    // num_words words per id
+    std::vector<int> counts;
+    std::vector<size_t> hashes;
+
+    std::vector<int> free_ids;
+    std::unordered_multimap<size_t, int> ids_by_hash;
+
+    static size_t Hash(std::span<const uint64_t> language_words);
+};
+
+#endif //LANGUAGETABLE_H
@@ -4,10 +4,12 @@
 
 #include "MainMenu.h"
 
+#include <filesystem>
 #include <iostream>
 #include <SFML/Window/Event.hpp>
 #include "Application.h"
 #include "CompStudySimulator.h"
+#include "ReplayViewer.h"
 #include "Simulator.h"
 #include "Utility.h"
 #include "editor/Editor.h"
@@ -31,11 +33,19 @@ void MainMenu::StartSimulation() {
         return;
     }
 
+    // Recorded trajectories are played back instead of simulated
+    if (std::filesystem::path(file_name).extension() == ".bin") {
+        auto replay = std::make_unique<ReplayViewer>(context, file_name, 1600, 900);
+        context->state_manager->AddState(std::move(replay));
+        return;
+    }
+
     if (auto loaded_data = serialization::LoadSimulationDataFromFile(file_name)) {
         auto simulation_name = ExtractFileName(file_name);
         if (loaded_data->type == CompSimulation) {
             KeySimulationData simulation_data = load_key_simulation_data(loaded_data);
             auto simulation = std::make_unique<CompSimulator>(context, simulation_data, simulation_name, 1600, 900);
+            simulation->EnableTrajectoryOutput();
             context->state_manager->AddState(std::move(simulation));
         }else if (loaded_data->type == EvoSimulation) {
             VectorSimulationData simulation_data = load_vector_simulation_data(loaded_data);
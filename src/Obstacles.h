@@ -10,8 +10,8 @@
 #include <Eigen/Dense>
 #include <SFML/Graphics.hpp>
 
-// Forward declaration of Boid class
-class Boid;
+// Forward declaration of BoidStore class
+class BoidStore;
 
 class Obstacle {
 public:
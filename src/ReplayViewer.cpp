@@ -0,0 +1,237 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "ReplayViewer.h"
+
+#include <iostream>
+#include <sstream>
+#include <SFML/Window/Event.hpp>
+
+#include "ResourceManager.h"
+#include "StateManager.h"
+#include "Utility.h"
+
+namespace {
+    // The boid stores size their packed language vectors on construction, so the language size is set up front
+    std::shared_ptr<SimulationConfig> CreateReplayConfig(const TrajectoryReader &trajectory) {
+        auto config = std::make_shared<SimulationConfig>();
+        config->LANGUAGE_SIZE = trajectory.LanguageSize();
+        return config;
+    }
+}
+
+ReplayViewer::ReplayViewer(std::shared_ptr<Context> &context, const std::string &filename, float camera_width, float camera_height)
+    : context(context),
+      trajectory(filename),
+      config(CreateReplayConfig(trajectory)),
+      camera(sf::Vector2f(0, 0), camera_width, camera_height),
+      key_boids(config, !context->headless),
+      vector_boids(config, !context->headless) {
+
+    // Play about 10 recorded frames per second
+    playback_speed = 10 * std::max(trajectory.LogInterval(), 0.1f);
+
+    if (const auto& p_font = ResourceManager::GetFont("arial")) {
+        status_text.setFont(*p_font);
+    }
+    status_text.setCharacterSize(20);
+    status_text.setFillColor(sf::Color::White);
+    status_text.setPosition(10.f, 10.f);
+}
+
+void ReplayViewer::Init() {
+    if (!trajectory.IsOpen()) {
+        std::cerr << "Error: Trajectory file is empty or invalid." << std::endl;
+        context->state_manager->PopState();
+        return;
+    }
+
+    // The recording has no world, fit the camera to the boids of the first frame
+    World world = CalcWorldBounds();
+    camera = Camera(sf::Vector2f(world.width / 2, world.height / 2), camera.default_width, camera.default_height);
+    camera.FitWorld(world);
+
+    SeekFrame(0);
+}
+
+World ReplayViewer::CalcWorldBounds() {
+    trajectory.ReadPositions(0, frame_positions);
+    Eigen::Vector2f max_pos = Eigen::Vector2f::Ones();
+    for (const auto& position : frame_positions) {
+        max_pos = max_pos.cwiseMax(position);
+    }
+    return World{max_pos.x(), max_pos.y(), {}, {}};
+}
+
+BoidStore& ReplayViewer::ActiveBoids() {
+    if (trajectory.LanguageSize() == 0) return key_boids;
+    return vector_boids;
+}
+
+void ReplayViewer::SeekFrame(int frame) {
+    frame = std::clamp(frame, 0, trajectory.NumFrames() - 1);
+    playhead_time = trajectory.FrameTime(frame);
+    ShowFrame(frame);
+}
+
+void ReplayViewer::ShowFrame(int frame) {
+    current_frame = frame;
+    int num_boids = trajectory.FrameBoids(frame);
+    trajectory.ReadPositions(frame, frame_positions);
+
+    // Match the amount of boids in the store to the frame
+    BoidStore& boids = ActiveBoids();
+    while (boids.Size() > num_boids) {
+        boids.RemoveBoid(boids.Size() - 1);
+    }
+    while (boids.Size() < num_boids) {
+        if (trajectory.LanguageSize() == 0) {
+            key_boids.AddBoid(Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), 0);
+        } else {
+            vector_boids.AddBoid(Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(), Eigen::Vector2f::Zero(),
+                                 Eigen::VectorXi::Zero(trajectory.LanguageSize()), 1);
+        }
+    }
+
+    // Velocities are only used to rotate the sprites, estimate them from the previous frame. Boid indices only match
+    // between frames when no boids were born or died.
+    bool has_previous = frame > 0 && trajectory.FrameBoids(frame - 1) == num_boids;
+    if (has_previous) trajectory.ReadPositions(frame - 1, previous_positions);
+    for (int i = 0; i < num_boids; ++i) {
+        boids.pos[i] = frame_positions[i];
+        boids.vel[i] = has_previous ? Eigen::Vector2f(frame_positions[i] - previous_positions[i]) : Eigen::Vector2f(1, 0);
+    }
+
+    if (trajectory.LanguageSize() == 0) {
+        trajectory.ReadLanguageKeys(frame, frame_language_keys);
+        for (int i = 0; i < num_boids; ++i) {
+            key_boids.language_key[i] = frame_language_keys[i];
+            key_boids.UpdateColor(i);
+        }
+    } else {
+        trajectory.ReadLanguageVectors(frame, frame_language_vectors);
+        for (int i = 0; i < num_boids; ++i) {
+            vector_boids.SetLanguageVector(i, frame_language_vectors[i]);
+        }
+    }
+    boids.UpdateSprites();
+
+    std::stringstream ss;
+    ss << "Frame: " << frame + 1 << " of " << trajectory.NumFrames()
+       << "\nTime: " << trajectory.FrameTime(frame) << "s"
+       << "\nSpeed: " << playback_speed << (playing ? "" : " (paused)");
+    status_text.setString(ss.str());
+}
+
+void ReplayViewer::ProcessInput() {
+    sf::Vector2i mouse_pos = sf::Mouse::getPosition(*context->window);
+    sf::Event event{};
+    while(context->window->pollEvent(event)) {
+        if (event.type == sf::Event::Closed) {
+            context->window->close();
+        }
+
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle) {
+            //Camera Drag
+            camera.StartDragging(mouse_pos);
+        }
+
+        if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle) {
+            //Camera Drag
+            camera.StopDragging();
+        }
+
+        if (event.type == sf::Event::MouseWheelScrolled) {
+            //Camera Zoom
+            camera.Zoom(event.mouseWheelScroll.delta > 0 ? -0.2f : 0.2f);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Space)) {
+            playing = !playing;
+            ShowFrame(current_frame);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::R)) {
+            playback_speed = -playback_speed;
+            ShowFrame(current_frame);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Up)) {
+            playback_speed *= 2;
+            ShowFrame(current_frame);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Down)) {
+            playback_speed /= 2;
+            ShowFrame(current_frame);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Right)) {
+            playing = false;
+            SeekFrame(current_frame + 1);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Left)) {
+            playing = false;
+            SeekFrame(current_frame - 1);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Home)) {
+            SeekFrame(0);
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::End)) {
+            SeekFrame(trajectory.NumFrames() - 1);
+        }
+
+        for (int digit = 0; digit <= 9; ++digit) {
+            if (IsKeyPressedOnce(static_cast<sf::Keyboard::Key>(sf::Keyboard::Num0 + digit))) {
+                SeekFrame(trajectory.NumFrames() * digit / 10);
+            }
+        }
+
+        if (IsKeyPressedOnce(sf::Keyboard::Escape)) {
+            context->state_manager->PopState();
+        }
+    }
+    camera.Drag(mouse_pos);
+}
+
+void ReplayViewer::Update(sf::Time delta_time) {
+    if (!playing || !trajectory.IsOpen()) return;
+
+    // Stop at either end of the recording
+    float start_time = trajectory.FrameTime(0);
+    float end_time = trajectory.FrameTime(trajectory.NumFrames() - 1);
+    playhead_time += delta_time.asSeconds() * playback_speed;
+    if (playhead_time <= start_time || playhead_time >= end_time) {
+        playhead_time = std::clamp(playhead_time, start_time, end_time);
+        playing = false;
+    }
+
+    int frame = trajectory.FindFrame(playhead_time);
+    if (frame != current_frame || !playing) {
+        ShowFrame(frame);
+    }
+}
+
+void ReplayViewer::Draw() {
+    context->window->clear(sf::Color::Black);
+
+    // Draw Boids
+    context->window->setView(camera.view);
+    for (const auto& sprite : ActiveBoids().sprites) {
+        context->window->draw(sprite);
+    }
+    context->window->setView(context->window->getDefaultView());
+
+    context->window->draw(status_text);
+    context->window->display();
+}
+
+void ReplayViewer::Pause() {
+}
+
+void ReplayViewer::Start() {
+}
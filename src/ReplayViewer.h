@@ -0,0 +1,60 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef REPLAYVIEWER_H
+#define REPLAYVIEWER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Application.h"
+#include "Boid.h"
+#include "Camera.h"
+#include "State.h"
+#include "analysis/TrajectoryReader.h"
+
+// Plays back a recorded trajectory file (see TrajectoryWriter) without rerunning the simulation.
+// Controls: SPACE play/pause, R reverse, UP/DOWN double/halve the speed, LEFT/RIGHT step one frame,
+// 0-9 seek to 0%-90% of the recording, HOME/END seek to the first/last frame.
+class ReplayViewer : public State {
+public:
+    std::shared_ptr<Context> context;
+    TrajectoryReader trajectory;
+    std::shared_ptr<SimulationConfig> config;
+    Camera camera;
+
+    // Boids of the current frame, drawn like in the simulators. Only the store matching the trajectory is used.
+    CompBoidStore key_boids;
+    EvoBoidStore vector_boids;
+
+    int current_frame = -1;
+    float playhead_time = 0;
+    float playback_speed;       // simulated seconds per second, negative plays in reverse
+    bool playing = true;
+    sf::Text status_text;
+
+    ReplayViewer(std::shared_ptr<Context>& context, const std::string& filename, float camera_width, float camera_height);
+
+    void ShowFrame(int frame);
+    void SeekFrame(int frame);
+
+    void Init() override;
+    void ProcessInput() override;
+    void Update(sf::Time delta_time) override;
+    void Pause() override;
+    void Draw() override;
+    void Start() override;
+
+private:
+    std::vector<Eigen::Vector2f> frame_positions;
+    std::vector<Eigen::Vector2f> previous_positions;
+    std::vector<int> frame_language_keys;
+    std::vector<Eigen::VectorXi> frame_language_vectors;
+
+    BoidStore& ActiveBoids();
+    World CalcWorldBounds();
+};
+
+#endif //REPLAYVIEWER_H
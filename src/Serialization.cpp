@@ -54,7 +54,8 @@ bool serialization::SaveSimulationDataToFile(const SimulationData& data) {
                  << "TOTAL_BOIDS: " << data.config->TOTAL_BOIDS << '\n'
                  << "RUNS_PER_FRACTION: " << data.config->RUNS_PER_FRACTION << '\n'
                  << "SECONDS_PER_RUN: " << data.config->TIME_STEPS_PER_RUN << '\n'
-                 << "FRACTIONS: " << data.config->FRACTIONS << '\n';
+                 << "FRACTIONS: " << data.config->FRACTIONS << '\n'
+                 << "CONFIDENCE_HALF_WIDTH: " << data.config->CONFIDENCE_HALF_WIDTH << '\n';
             break;
     }
 
@@ -71,7 +72,8 @@ bool serialization::SaveSimulationDataToFile(const SimulationData& data) {
          << "BOID_COLLISION_RADIUS: " << data.config->BOID_COLLISION_RADIUS << '\n'
          << "RESTITUTION_COEFFICIENT: " << data.config->RESTITUTION_COEFFICIENT << '\n'
          << "ANALYSIS_LOG_INTERVAL: " << data.config->ANALYSIS_LOG_INTERVAL << '\n'
-         << "MULTI_THREADING_ON: " << data.config->MULTI_THREADING << '\n';
+         << "MULTI_THREADING_ON: " << data.config->MULTI_THREADING << '\n'
+         << "SEED: " << data.config->SEED << '\n';
 
     // Write the world width and height
     file << "Size: " << data.world.width << " , " << data.world.height << "\n";
@@ -146,6 +148,8 @@ std::optional<SimulationData> serialization::LoadSimulationDataFromFile(const st
             data.config->RUNS_PER_FRACTION = static_cast<int>(value);
         } else if (prefix == "FRACTIONS:") {
             data.config->FRACTIONS = static_cast<int>(value);
+        } else if (prefix == "CONFIDENCE_HALF_WIDTH:") {
+            data.config->CONFIDENCE_HALF_WIDTH = value;
         } else if (prefix == "TOTAL_BOIDS:") {
             data.config->TOTAL_BOIDS = static_cast<int>(value);
         } else if (prefix == "SECONDS_PER_RUN:") {
@@ -192,6 +196,9 @@ std::optional<SimulationData> serialization::LoadSimulationDataFromFile(const st
             data.config->ANALYSIS_LOG_INTERVAL = static_cast<int>(value);
         } else if (prefix == "MULTI_THREADING_ON:") {
             data.config->MULTI_THREADING = static_cast<int>(value);
+        } else if (prefix == "SEED:") {
+            // Re-read as an integer, seeds above 2^24 do not survive the float conversion
+            std::stringstream(line) >> prefix >> data.config->SEED;
         } else {
             break;
         }
@@ -333,7 +340,7 @@ std::string serialization::GetFileNameThroughLoadDialog() {
     ofn.lpstrFile = fileName;
     ofn.lpstrFile[0] = '\0';
     ofn.nMaxFile = MAX_PATH;
-    ofn.lpstrFilter = "DAT Files (*.dat)\0*.dat\0All Files\0*.*\0";
+    ofn.lpstrFilter = "DAT Files (*.dat)\0*.dat\0Trajectory Files (*.bin)\0*.bin\0All Files\0*.*\0";
     ofn.nFilterIndex = 1;
     ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST | OFN_EXPLORER;
 
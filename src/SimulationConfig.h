@@ -43,9 +43,16 @@ struct SimulationConfig {
     int RUNS_PER_FRACTION = 50;
     int FRACTIONS = 50;
     int TOTAL_BOIDS = 1000;
+    // Adaptive study (0 = off): a fraction stops once the 95% confidence interval of the probability that language 0
+    // dominates has at most this half-width, with up to twice RUNS_PER_FRACTION runs for fractions near the tipping point
+    float CONFIDENCE_HALF_WIDTH = 0;
 
     // Multi-Threading (Experimental)
     bool MULTI_THREADING = 1;
+
+    // Reproducibility: a non-zero seed makes runs deterministic, giving identical results for any number of threads
+    // (also with MULTI_THREADING off)
+    unsigned int SEED = 0;
 };
 
 #endif //CONFIGURATION_H
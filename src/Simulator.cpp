@@ -2,24 +2,48 @@
 // Created by wouter on 20-2-2024.
 //
 
+#include <chrono>
 #include <SFML/Window/Event.hpp>
 #include "Simulator.h"
 #include "ResourceManager.h"
+#include "Utility.h"
 
 Simulator::Simulator(std::shared_ptr<Context>& context, std::shared_ptr<SimulationConfig>& config, World& world, float camera_width, float camera_height)
     : context(context),
       config(config),
       world(world),
       camera(Camera(sf::Vector2f(world.width / 2, world.height / 2), camera_width, camera_height)),
-      selected_boid(nullptr) {
+      seed(config->SEED) {
 
-    const auto& p_texture = ResourceManager::GetTexture("boid_selection");
-    boid_selection_border.setTexture(*p_texture);
-    boid_selection_border.setOrigin(p_texture->getSize().x/2.0f, p_texture->getSize().y/2.0f);
+    // Textures are not loaded in headless runs
+    if (const auto& p_texture = ResourceManager::GetTexture("boid_selection")) {
+        boid_selection_border.setTexture(*p_texture);
+        boid_selection_border.setOrigin(p_texture->getSize().x/2.0f, p_texture->getSize().y/2.0f);
+    }
+}
+
+bool Simulator::IsDeterministic() const {
+    return config->SEED != 0;
+}
+
+void Simulator::SeedRandomStream(uint64_t stream) const {
+    // Seeds the generator of the calling thread, so the draws only depend on the seed, the step and the stream
+    if (IsDeterministic()) {
+        SeedThreadRandomGenerator(CreateStreamSeed(seed, stream, step_nr));
+    }
 }
 
-template <typename BoidType>
-void Simulator::ProcessBoidSelection(const Context* context, sf::Vector2i& mouse_pos, SpatialGrid<BoidType>& spatial_boid_grid) {
+void Simulator::RunFastForwardTicks(const std::function<void()> &tick) {
+    // The amount of ticks adapts to the cost of a tick, so the window keeps responding for large worlds
+    auto frame_end = std::chrono::steady_clock::now() + std::chrono::duration<float>(FAST_FORWARD_FRAME_BUDGET);
+    ticks_last_frame = 0;
+    do {
+        tick();
+        ticks_last_frame++;
+    } while (ticks_last_frame < MAX_TICKS_PER_FRAME && std::chrono::steady_clock::now() < frame_end);
+}
+
+void Simulator::ProcessBoidSelection(const Context* context, sf::Vector2i& mouse_pos, const SpatialGrid& spatial_boid_grid, const BoidStore& boids) {
     //Get World coordinates
     auto sf_world_pos = context->window->mapPixelToCoords(mouse_pos, camera.view);
     auto world_pos = Eigen::Vector2f(sf_world_pos.x, sf_world_pos.y);
@@ -27,10 +51,10 @@ void Simulator::ProcessBoidSelection(const Context* context, sf::Vector2i& mouse
 
     //Boid Selection
     auto selected_boids = spatial_boid_grid.LocalSearch(world_pos);
-    for (auto& boid : selected_boids) {
-        if ((boid->pos - world_pos).norm() <= boid->collision_radius) {
-            if (boid == selected_boid) selected_boid = nullptr;
-            else selected_boid = boid;
+    for (int boid : selected_boids) {
+        if ((boids.pos[boid] - world_pos).norm() <= boids.collision_radius) {
+            if (selected_boid == boids.GetHandle(boid)) selected_boid.reset();
+            else selected_boid = boids.GetHandle(boid);
             break;
         }
     }
@@ -45,12 +69,16 @@ void Simulator::ProcessCameraZoom(const sf::Event &event) {
     }
 }
 
-void Simulator::DrawBoidSelectionCircle() {
-    if (selected_boid != nullptr) {
+void Simulator::DrawBoidSelectionCircle(const BoidStore& boids) {
+    if (!selected_boid) return;
+
+    if (int index = boids.GetIndex(*selected_boid); index != -1) {
+        const Eigen::Vector2f& pos = boids.pos[index];
+        const Eigen::Vector2f& vel = boids.vel[index];
 
-        auto DrawSelectionCircle = [this](float radius, sf::Color color) {
+        auto DrawSelectionCircle = [this, &pos](float radius, sf::Color color) {
             sf::CircleShape circle(radius);
-            circle.setPosition(selected_boid->pos.x(), selected_boid->pos.y());
+            circle.setPosition(pos.x(), pos.y());
             circle.setOrigin(radius, radius);
             circle.setFillColor(sf::Color::Transparent);
             circle.setOutlineThickness(4);
@@ -59,12 +87,12 @@ void Simulator::DrawBoidSelectionCircle() {
         };
 
         // Draw selection Circle
-        DrawSelectionCircle(selected_boid->interaction_radius, sf::Color(180,180,180));
-        DrawSelectionCircle(selected_boid->perception_radius, sf::Color(120,120,120));
+        DrawSelectionCircle(boids.interaction_radius, sf::Color(180,180,180));
+        DrawSelectionCircle(boids.perception_radius, sf::Color(120,120,120));
 
         // Draw triangular selection border
-        boid_selection_border.setPosition(selected_boid->pos.x(), selected_boid->pos.y());
-        auto angle = static_cast<float>(std::atan2(selected_boid->vel.y(), selected_boid->vel.x()) * 180 / std::numbers::pi);
+        boid_selection_border.setPosition(pos.x(), pos.y());
+        auto angle = static_cast<float>(std::atan2(vel.y(), vel.x()) * 180 / std::numbers::pi);
         boid_selection_border.setRotation(angle);
         context->window->draw(boid_selection_border);
     }
@@ -84,8 +112,3 @@ void Simulator::CreateWorldBorderLines() {
     line = std::make_shared<LineObstacle>(p4, p1, 10, sf::Color::White);
     world.obstacles.push_back(line);
 }
-
-// This explicit instantiation informs the compiler to generate the code for the template function for the below specified template arguments, making it available for linking.
-template void Simulator::ProcessBoidSelection<CompBoid>(const Context*, sf::Vector2i&, SpatialGrid<CompBoid>&);
-template void Simulator::ProcessBoidSelection<EvoBoid>(const Context*, sf::Vector2i&, SpatialGrid<EvoBoid>&);
-
@@ -5,15 +5,20 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
+#include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 
 #include "Boid.h"
 #include "State.h"
 #include "Camera.h"
+#include "FeatureCountGrid.h"
 #include "analysis/CompAnalyser.h"
 #include "LanguageManager.h"
 #include "Obstacles.h"
 #include "SimulationData.h"
+#include "ResourceManager.h"
 #include "SpatialGrid.tpp"
 #include "Application.h"
 #include "analysis/EvoAnalyser.h"
@@ -24,21 +29,42 @@ public:
     std::shared_ptr<SimulationConfig> config;
     World world;
     Camera camera;
-    Boid* selected_boid;
+    std::optional<BoidHandle> selected_boid;
     sf::Sprite boid_selection_border;
     std::shared_ptr<sf::Texture>  boid_selection_texture;
     float total_simulation_time = 0.f;
+    std::string checkpoint_file_path;
+
+    // Deterministic runs (config->SEED != 0): every boid draws from its own random stream, reseeded each step
+    uint64_t seed;
+    uint64_t step_nr = 0;
+    static constexpr uint64_t SEQUENTIAL_STREAM = ~0ull; // stream for random draws outside the per-boid updates
+    static constexpr float FIXED_TIME_STEP = 1 / 30.f;
+
+    // Work chunks handed out per thread in the parallel update step. More chunks than threads lets threads that
+    // finish early take over the remaining chunks.
+    static constexpr int WORK_CHUNKS_PER_THREAD = 8;
+
+    // Fast-forward: every frame runs as many FIXED_TIME_STEP ticks as fit in the frame budget (wall-clock seconds),
+    // only the state after the last tick is drawn
+    bool fast_forward = false;
+    int ticks_last_frame = 0;
+    static constexpr float FAST_FORWARD_FRAME_BUDGET = 1 / 30.f;
+    static constexpr int MAX_TICKS_PER_FRAME = 1000;
 
     Simulator(std::shared_ptr<Context> &context, std::shared_ptr<SimulationConfig>& config, World &world, float camera_width, float camera_height);
 
+    bool IsDeterministic() const;
+    void SeedRandomStream(uint64_t stream) const;
+    void RunFastForwardTicks(const std::function<void()>& tick);
+
     // ProcessInput Methods
-    template <typename BoidType>
-    void ProcessBoidSelection(const Context* context, sf::Vector2i& mouse_pos, SpatialGrid<BoidType>& spatial_boid_grid);
+    void ProcessBoidSelection(const Context* context, sf::Vector2i& mouse_pos, const SpatialGrid& spatial_boid_grid, const BoidStore& boids);
 
     void ProcessCameraZoom(const sf::Event &event);
 
     // Draw methods
-    void DrawBoidSelectionCircle();
+    void DrawBoidSelectionCircle(const BoidStore& boids);
 
     void CreateWorldBorderLines();
 };
@@ -46,13 +72,6 @@ public:
 class EvoSimulator : public Simulator {
 public:
 
-    struct UpdatedBoidValues {
-        std::map<EvoBoid*, Eigen::Vector2f> acceleration_values;
-        std::map<EvoBoid*, std::set<int>> language_features;
-        std::map<EvoBoid*, bool> marked_for_death;
-        std::map<EvoBoid*, Eigen::VectorXi> most_common_language;
-    };
-
     struct BoidValues {
         BoidValues() = default;
         Eigen::Vector2f acceleration_value;
@@ -61,33 +80,34 @@ public:
         Eigen::VectorXi most_common_language;
     };
 
-    using BoidValueMap = std::map<EvoBoid*, std::shared_ptr<BoidValues>>;
+    SpatialGrid spatial_boid_grid;
+    EvoBoidStore boids;
+    FeatureCountGrid feature_count_grid;    // feature histograms per cell of spatial_boid_grid
 
-    SpatialGrid<EvoBoid> spatial_boid_grid;
-    std::vector<std::shared_ptr<EvoBoid>> boids;
+    // Results of the parallel update step, one slot per boid (indexed by boid index)
+    std::vector<BoidValues> updated_boid_values;
     std::vector<std::shared_ptr<EvoBoidSpawner>> boid_spawners;
     sf::Text selected_boid_language_display;
 
     //Analysis
-    std::shared_ptr<EvoAnalyser> analyser;
+    std::unique_ptr<EvoAnalyser> analyser;
     std::string output_file_path;
 
     // Multi-Threading
-    std::mutex mtx;
     const size_t num_threads;
+    std::vector<int> work_chunk_start;  // chunks of spatial_boid_grid.cell_boids, see SpatialGrid::CreateWorkChunks
 
     EvoSimulator(std::shared_ptr<Context>& context, VectorSimulationData& simulation_data, std::string simulation_name,
                  float camera_width, float camera_height);
 
     void Init() override;
-    void AddBoid(const std::shared_ptr<EvoBoid> &boid);
 
     void Update(sf::Time delta_time) override;
+    void Step(sf::Time delta_time);
     void MultiThreadUpdate(sf::Time delta_time);
 
-    BoidValueMap MultiThreadUpdateStepOne(int start_index, int end_index, sf::Time delta_time) const;
-    void RemoveDeadBoidsAndAddOffspring(std::map<EvoBoid *, std::shared_ptr<BoidValues>> updated_boid_values
-    );
+    void MultiThreadUpdateStepOne(std::span<const int> boid_indices, sf::Time delta_time, std::vector<BoidValues> &boid_values) const;
+    void RemoveDeadBoidsAndAddOffspring(const std::vector<BoidValues> &boid_values);
 
     void UpdateBoidsStepTwo(sf::Time delta_time);
     void ProcessInput() override;
@@ -106,19 +126,20 @@ public:
 class CompSimulator : public Simulator {
 public:
 
+    // Results of the parallel update step, one slot per boid (indexed by boid index)
     struct UpdatedBoidValues {
-        std::map<CompBoid*, Eigen::Vector2f> acceleration_values;
-        std::map<CompBoid*, std::pair<int, float>> language_and_satisfaction_values;
+        std::vector<Eigen::Vector2f> acceleration_values;
+        std::vector<std::pair<int, float>> language_and_satisfaction_values;
     };
 
-    SpatialGrid<CompBoid> spatial_boid_grid;
-    std::vector<std::shared_ptr<CompBoid>> boids;
+    SpatialGrid spatial_boid_grid;
+    CompBoidStore boids;
+    UpdatedBoidValues updated_boid_values;
     std::vector<std::shared_ptr<CompBoidSpawner>> boid_spawners;
 
     // Multi-Threading
-    std::mutex mtx;
     const size_t num_threads;
-    std::vector<std::vector<std::shared_ptr<CompBoid>>> boid_chunks;
+    std::vector<int> work_chunk_start;  // chunks of spatial_boid_grid.cell_boids, see SpatialGrid::CreateWorkChunks
 
     // analysis
     std::unique_ptr<CompAnalyser> analyser;
@@ -132,15 +153,14 @@ public:
     CompSimulator(std::shared_ptr<Context>& context, KeySimulationData& simulation_data, std::string simulation_name, float camera_width, float camera_height);
 
     void Init() override;
+    void EnableTrajectoryOutput();
 
-    void DivideBoidChunks();
-
-    UpdatedBoidValues UpdateBoidsStepOneMultithread(const std::vector<std::shared_ptr<CompBoid> > &boids,
-                                                                  sf::Time delta_time) const;
+    void UpdateBoidsStepOneMultithread(std::span<const int> boid_indices, sf::Time delta_time, UpdatedBoidValues &boid_values) const;
 
-    void UpdateBoidsStepOne(const std::vector<std::shared_ptr<CompBoid>> &boids, sf::Time delta_time) const;
-    void UpdateBoidsStepTwo(const std::vector<std::shared_ptr<CompBoid>> &boids, sf::Time delta_time);
+    void UpdateBoidsStepOne(sf::Time delta_time);
+    void UpdateBoidsStepTwo(sf::Time delta_time);
     void Update(sf::Time delta_time) override;
+    void Step(sf::Time delta_time);
 
     void ProcessInput() override;
 
@@ -151,8 +171,6 @@ public:
     void Start() override;
     void Pause() override;
 
-    void AddBoid(const std::shared_ptr<CompBoid> &boid);
-
 };
 
 #endif //SIMULATION_H
@@ -0,0 +1,200 @@
+//
+// Created by wouter on 21-2-2024.
+//
+
+#include "SpatialGrid.tpp"
+
+SpatialGrid::SpatialGrid(Eigen::Vector2i world_dimensions, int cell_size)
+    : cell_size(std::max(cell_size, 1)), world_dimensions(std::move(world_dimensions)), is_visible(false){
+
+    // Queries are clipped to the grid bounds, so the grid only has to cover the world itself
+    grid_dimensions.x() = std::max(1, static_cast<int>(std::ceil(this->world_dimensions.x() / static_cast<double>(this->cell_size))));
+    grid_dimensions.y() = std::max(1, static_cast<int>(std::ceil(this->world_dimensions.y() / static_cast<double>(this->cell_size))));
+
+    // Initialize the (empty) cell buckets
+    int num_cells = grid_dimensions.x() * grid_dimensions.y();
+    max_possible_key = num_cells - 1;
+    cell_start = std::vector<int>(num_cells + 1, 0);
+}
+
+int SpatialGrid::CreateKeyFromIndex(int x, int y) const {
+    return x + y * grid_dimensions.x();
+}
+
+int SpatialGrid::GetColumn(float x) const {
+    return std::clamp(static_cast<int>(std::floor(x / static_cast<float>(cell_size))), 0, grid_dimensions.x() - 1);
+}
+
+int SpatialGrid::GetRow(float y) const {
+    return std::clamp(static_cast<int>(std::floor(y / static_cast<float>(cell_size))), 0, grid_dimensions.y() - 1);
+}
+
+Eigen::Vector2i SpatialGrid::GetIndex(Eigen::Vector2f position) const {
+    // Boids that (temporarily) leave the world are kept in the nearest border cell
+    return {GetColumn(position.x()), GetRow(position.y())};
+}
+
+int SpatialGrid::GetCellSize(int key) const {
+    return cell_start[key + 1] - cell_start[key];
+}
+
+void SpatialGrid::DrawGrid(sf::RenderWindow* window) {
+    if (is_visible) {
+        for (int r = 0; r < grid_dimensions.y(); ++r) {
+            for (int c = 0; c < grid_dimensions.x(); ++c) {
+                int key = CreateKeyFromIndex(c, r);
+                if (int num_boids = GetCellSize(key); num_boids > 0) {
+                    // Calculate grayscale color value based on number of boids
+                    int grayscale_value = std::min(num_boids * 10, 255);
+
+                    sf::RectangleShape rect(sf::Vector2f(cell_size, cell_size));
+                    rect.setPosition(c * cell_size, r * cell_size);
+                    rect.setFillColor(sf::Color::Transparent);
+
+                    // Set outline color based on grayscale value
+                    rect.setOutlineColor(sf::Color(grayscale_value, grayscale_value, grayscale_value));
+                    rect.setOutlineThickness(3);
+                    window->draw(rect);
+
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::Rebuild(const std::vector<Eigen::Vector2f> &positions) {
+    int num_boids = static_cast<int>(positions.size());
+    boid_keys.resize(num_boids);
+    boid_cell_slots.resize(num_boids);
+    cell_boids.resize(num_boids);
+    cell_positions.resize(num_boids);
+
+    // Count the number of boids in each cell
+    std::fill(cell_start.begin(), cell_start.end(), 0);
+    for (int i = 0; i < num_boids; ++i) {
+        Eigen::Vector2i index = GetIndex(positions[i]);
+        boid_keys[i] = CreateKeyFromIndex(index.x(), index.y());
+        cell_start[boid_keys[i]]++;
+    }
+
+    // Running sum, cell_start[key] now points one past the last slot of each cell
+    for (size_t key = 1; key < cell_start.size(); ++key) {
+        cell_start[key] += cell_start[key - 1];
+    }
+
+    // Fill the slots back to front, which leaves cell_start[key] pointing at the first slot of each cell
+    // and keeps the boids within a cell in index order.
+    for (int i = num_boids - 1; i >= 0; --i) {
+        int slot = --cell_start[boid_keys[i]];
+        cell_boids[slot] = i;
+        cell_positions[slot] = positions[i];
+        boid_cell_slots[i] = slot;
+    }
+}
+
+void SpatialGrid::ObjRadiusSearch(float query_radius, int index, std::vector<int>& result) const {
+    result.clear();
+    ForEachObjInRadius(query_radius, index, [&result](int other_index, float) {
+        result.push_back(other_index);
+    });
+}
+
+void SpatialGrid::PosRadiusSearch(float query_radius, Eigen::Vector2f position, std::vector<int>& result) const {
+    result.clear();
+    ForEachPosInRadius(query_radius, position, [&result](int other_index, float) {
+        result.push_back(other_index);
+    });
+}
+
+void SpatialGrid::ObjDualRadiusSearch(float first_radius, float second_radius, int index,
+                                      std::vector<int>& first_result, std::vector<int>& second_result) const {
+    first_result.clear();
+    second_result.clear();
+
+    float squared_first_radius = first_radius * first_radius;
+    float squared_second_radius = second_radius * second_radius;
+    ForEachObjInRadius(std::max(first_radius, second_radius), index, [&](int other_index, float squared_distance) {
+        if (squared_distance <= squared_first_radius) first_result.push_back(other_index);
+        if (squared_distance <= squared_second_radius) second_result.push_back(other_index);
+    });
+}
+
+std::vector<int> SpatialGrid::ObjRadiusSearch(float query_radius, int index) const {
+    std::vector<int> boids_in_radius;
+    ObjRadiusSearch(query_radius, index, boids_in_radius);
+    return boids_in_radius;
+}
+
+std::vector<int> SpatialGrid::PosRadiusSearch(float query_radius, Eigen::Vector2f position) const {
+    std::vector<int> boids_in_radius;
+    PosRadiusSearch(query_radius, position, boids_in_radius);
+    return boids_in_radius;
+}
+
+std::vector<int> SpatialGrid::LocalSearch(Eigen::Vector2f position) const {
+    std::vector<int> boids_in_cell;
+
+    // Check the cell of the position and its direct neighbours (clipped to the grid)
+    Eigen::Vector2i index = GetIndex(position);
+    int first_column = std::max(index.x() - 1, 0);
+    int last_column = std::min(index.x() + 1, grid_dimensions.x() - 1);
+    for (int row = std::max(index.y() - 1, 0); row <= std::min(index.y() + 1, grid_dimensions.y() - 1); ++row) {
+        int first_key = CreateKeyFromIndex(first_column, row);
+        int last_key = CreateKeyFromIndex(last_column, row);
+        for (int slot = cell_start[first_key]; slot < cell_start[last_key + 1]; ++slot) {
+            boids_in_cell.push_back(cell_boids[slot]);
+        }
+    }
+
+    return boids_in_cell;
+}
+
+int SpatialGrid::CountNeighbourhood(int column, int row) const {
+    // Number of boids in the cell and its direct neighbours (clipped to the grid)
+    int first_column = std::max(column - 1, 0);
+    int last_column = std::min(column + 1, grid_dimensions.x() - 1);
+    int count = 0;
+    for (int r = std::max(row - 1, 0); r <= std::min(row + 1, grid_dimensions.y() - 1); ++r) {
+        count += cell_start[CreateKeyFromIndex(last_column, r) + 1] - cell_start[CreateKeyFromIndex(first_column, r)];
+    }
+    return count;
+}
+
+void SpatialGrid::CreateWorkChunks(int num_chunks, std::vector<int>& chunk_start) const {
+    num_chunks = std::max(num_chunks, 1);
+    chunk_start.assign(num_chunks + 1, static_cast<int>(cell_boids.size()));
+    chunk_start[0] = 0;
+
+    // Estimated cost of a boid: the number of boids it has to check, i.e. the boids in the surrounding cells
+    std::vector<long long> cell_boid_cost(max_possible_key + 1, 0);
+    long long total_cost = 0;
+    for (int row = 0; row < grid_dimensions.y(); ++row) {
+        for (int column = 0; column < grid_dimensions.x(); ++column) {
+            int key = CreateKeyFromIndex(column, row);
+            if (int num_boids = GetCellSize(key); num_boids > 0) {
+                cell_boid_cost[key] = 1 + CountNeighbourhood(column, row);
+                total_cost += num_boids * cell_boid_cost[key];
+            }
+        }
+    }
+
+    // Walk through the boids in cell order, starting the next chunk once the previous chunks hold their share of the cost
+    long long cost = 0;
+    int chunk = 1;
+    for (int key = 0; key <= max_possible_key; ++key) {
+        for (int slot = cell_start[key]; slot < cell_start[key + 1]; ++slot) {
+            while (chunk < num_chunks && cost * num_chunks >= total_cost * chunk) {
+                chunk_start[chunk++] = slot;
+            }
+            cost += cell_boid_cost[key];
+        }
+    }
+}
+
+void SpatialGrid::Clear() {
+    boid_keys.clear();
+    boid_cell_slots.clear();
+    cell_boids.clear();
+    cell_positions.clear();
+    std::fill(cell_start.begin(), cell_start.end(), 0);
+}
@@ -5,14 +5,12 @@
 #ifndef SPATIALGRID_H
 #define SPATIALGRID_H
 
-#include <map>
-#include <memory>
-#include <unordered_set>
+#include <vector>
 
-#include "Boid.h"
 #include "Eigen/Dense"
+#include <SFML/Graphics.hpp>
 
-template<typename ObjType>
+// Uniform grid over the boid positions. Boids are referred to by their index in the boid store.
 class SpatialGrid {
 public:
     int cell_size;
@@ -21,28 +19,70 @@ public:
     Eigen::Vector2i world_dimensions;
     bool is_visible;
 
-    std::map<int,int> num_offsets_within_distance;
-    std::vector<int> global_offset;
-    int max_d2;
-
     int CreateKeyFromIndex(int x, int y) const;
-    Eigen::Vector2i GetIndex(Eigen::Vector2f position);
+    Eigen::Vector2i GetIndex(Eigen::Vector2f position) const;
+    int GetColumn(float x) const;
+    int GetRow(float y) const;
+
+    // Cell key of every boid, indexed by boid index.
+    std::vector<int> boid_keys;
 
-    std::map<int, std::unordered_set<std::shared_ptr<ObjType>>> grid;
+    // Counting-sort buckets: the boids in cell 'key' are stored contiguously in
+    // cell_boids[cell_start[key] .. cell_start[key + 1]), with their positions in cell_positions.
+    std::vector<int> cell_start;
+    std::vector<int> cell_boids;
+    std::vector<Eigen::Vector2f> cell_positions;
 
     SpatialGrid(Eigen::Vector2i world_dim, int cell_size);
     ~SpatialGrid() = default;
     void Clear();
 
-    void AddObj(const std::shared_ptr<ObjType>& obj);
-    void RemoveObj(const std::shared_ptr<ObjType> &obj);
-    void UpdateObj(const std::shared_ptr<ObjType> &obj);
+    // Sort all boids into their cells. Must be called after boids were added, removed or moved,
+    // before querying the grid again.
+    void Rebuild(const std::vector<Eigen::Vector2f> &positions);
+
+    std::vector<int> ObjRadiusSearch(float query_radius, int index) const;
+    std::vector<int> PosRadiusSearch(float query_radius, Eigen::Vector2f position) const;
+    std::vector<int> LocalSearch(Eigen::Vector2f position) const;
+
+    // Allocation-free variants: the result buffer is cleared and refilled, so a buffer reused across
+    // queries only allocates when it has to grow.
+    void ObjRadiusSearch(float query_radius, int index, std::vector<int> &result) const;
+    void PosRadiusSearch(float query_radius, Eigen::Vector2f position, std::vector<int> &result) const;
+
+    // Single sweep over the larger of both radii, filling both result buffers at once. Gives the same sets
+    // as two separate ObjRadiusSearch calls (boids within the smaller radius end up in both buffers).
+    void ObjDualRadiusSearch(float first_radius, float second_radius, int index,
+                             std::vector<int> &first_result, std::vector<int> &second_result) const;
 
-    std::vector<ObjType*> ObjRadiusSearch(float query_radius, const std::shared_ptr<ObjType> &obj) const;
-    std::vector<ObjType*> PosRadiusSearch(float query_radius, Eigen::Vector2f position);
-    std::vector<ObjType*> LocalSearch(Eigen::Vector2f position);
+    // Calls visitor(int other_index, float squared_distance) for every other boid within the query radius.
+    template<typename Visitor>
+    void ForEachObjInRadius(float query_radius, int index, Visitor &&visitor) const;
+    template<typename Visitor>
+    void ForEachPosInRadius(float query_radius, Eigen::Vector2f position, Visitor &&visitor) const;
+
+    // Sums, over every other boid within the query radius, the count of that boid. Cells that lie completely inside
+    // the radius are summed with cell_count(int key) without visiting their boids, the boids in cells crossing the
+    // edge are counted one by one with boid_count(int other_index). Gives the same total as ForEachObjInRadius.
+    template<typename CellCount, typename BoidCount>
+    int CountObjInRadius(float query_radius, int index, CellCount &&cell_count, BoidCount &&boid_count) const;
+
+    // Cuts the boids in cell order (cell_boids) into 'num_chunks' consecutive work chunks with a similar estimated
+    // amount of neighbours to visit, so dense cells do not end up in a single chunk. Chunk c consists of
+    // cell_boids[chunk_start[c] .. chunk_start[c + 1]). Chunks can be empty when there are few boids.
+    void CreateWorkChunks(int num_chunks, std::vector<int> &chunk_start) const;
 
     void DrawGrid(sf::RenderWindow* window);
+
+private:
+    // Position of each boid inside the cell_boids array, indexed by boid index.
+    std::vector<int> boid_cell_slots;
+
+    int GetCellSize(int key) const;
+    int CountNeighbourhood(int column, int row) const;
+
+    template<typename Visitor>
+    void ForEachInRadius(float query_radius, Eigen::Vector2f position, int excluded_index, Visitor &&visitor) const;
 };
 
 
@@ -5,231 +5,105 @@
 #ifndef SPATIALGRID_TPP
 #define SPATIALGRID_TPP
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <limits>
 #include <utility>
 
-#include "ResourceManager.h"
 #include "SpatialGrid.h"
 
-template <typename ObjType>
-SpatialGrid<ObjType>::SpatialGrid(Eigen::Vector2i world_dimensions, int cell_size)
-    : cell_size(cell_size), world_dimensions(std::move(world_dimensions)), is_visible(false){
+template<typename Visitor>
+void SpatialGrid::ForEachInRadius(float query_radius, Eigen::Vector2f position, int excluded_index, Visitor&& visitor) const {
 
-    // To allow for maximum query distances, the grid length is doubled in both dimensions
-    grid_dimensions.x() = ceil(this->world_dimensions.x() * 2 / static_cast<double>(cell_size));
-    grid_dimensions.y() = ceil(this->world_dimensions.y() * 2 / static_cast<double>(cell_size));
-
-    Eigen::Vector2i center = grid_dimensions / 2;
-    int center_key = CreateKeyFromIndex(center.x(), center.y());
-
-    std::map<int, std::unordered_set<int>> offsets_by_distance_to_center {};
-    int max_dist_squared = 0;
-
-    for (int rowIndex = 0; rowIndex < grid_dimensions.y(); ++rowIndex) {
-        for (int colIndex = 0; colIndex < grid_dimensions.x(); ++colIndex) {
-            if (rowIndex == center.y() && colIndex == center.x()) {
-                offsets_by_distance_to_center[0].insert(0);
-                continue;
-            }
-            // Create key for new cell
-            int key = CreateKeyFromIndex(colIndex, rowIndex);
-
-            // Calculate minimum distance from center cell to this new cell
-            int d_x = std::max((abs(colIndex - center.x())-1),0); // min. horizontal dist between this cell to center cell
-            int d_y = std::max((abs(rowIndex - center.y())-1),0); // min. vertical dist between this cell to center cell
-            int dist_squared = static_cast<int>(std::pow(d_x, 2) + std::pow(d_y, 2));
-            offsets_by_distance_to_center[dist_squared].insert(key - center_key);
+    float squared_query_radius = query_radius * query_radius;
 
-            max_dist_squared = std::max(dist_squared, max_dist_squared); // record max squaredDist
-        }
-    }
+    // Rows overlapping the query circle, clipped to the grid
+    int first_row = GetRow(position.y() - query_radius);
+    int last_row = GetRow(position.y() + query_radius);
 
-    max_d2 = max_dist_squared;
+    for (int row = first_row; row <= last_row; ++row) {
+        // Vertical distance between the query position and this row (zero if the position lies inside it).
+        // The border rows also hold the boids outside the world, so they extend indefinitely.
+        float row_top = row == 0 ? -std::numeric_limits<float>::infinity() : static_cast<float>(row * cell_size);
+        float row_bottom = row == grid_dimensions.y() - 1 ? std::numeric_limits<float>::infinity() : static_cast<float>((row + 1) * cell_size);
+        float d_y = std::max({0.f, row_top - position.y(), position.y() - row_bottom});
+        if (d_y > query_radius) continue;
 
-    int num_cells = grid_dimensions.x() * grid_dimensions.y();
-    global_offset = std::vector<int>(num_cells);
+        // Narrow the column span to the width of the circle at this row, clipped to the grid
+        float half_width = std::sqrt(squared_query_radius - d_y * d_y);
+        int first_key = CreateKeyFromIndex(GetColumn(position.x() - half_width), row);
+        int last_key = CreateKeyFromIndex(GetColumn(position.x() + half_width), row);
 
-    // Set and initialize all keys in the obj storage grid:
-    max_possible_key = num_cells - 1;
-    for (int k = 0; k <= max_possible_key; ++k) {
-        grid[k] = std::unordered_set<std::shared_ptr<ObjType>>{};
-    }
+        // Cells in a row have consecutive keys, so their buckets form one contiguous range of slots
+        for (int slot = cell_start[first_key]; slot < cell_start[last_key + 1]; ++slot) {
+            if (cell_boids[slot] == excluded_index) continue;
 
-    int n = 0;
-    // d2 stands for distance squared
-    for(int d2 = 0; d2 <= max_dist_squared; ++d2) {
-        if(offsets_by_distance_to_center[d2].empty()) {
-            // if there are no cells whose min. squared dist. to center is d2:
-            num_offsets_within_distance[d2] = num_offsets_within_distance[d2-1];
-        } else {
-            for(auto& offset : offsets_by_distance_to_center[d2]) {
-                global_offset[n] = offset;
-                n++;
+            Eigen::Vector2f difference = (position - cell_positions[slot]);
+            float squared_distance = difference.squaredNorm();
+            if (squared_distance <= squared_query_radius) {
+                visitor(cell_boids[slot], squared_distance);
             }
-            num_offsets_within_distance[d2] = n;
         }
     }
 }
 
-template <typename ObjType>
-int SpatialGrid<ObjType>::CreateKeyFromIndex(int x, int y) const {
-    return x + y * grid_dimensions.x();
+template<typename Visitor>
+void SpatialGrid::ForEachObjInRadius(float query_radius, int index, Visitor&& visitor) const {
+    ForEachInRadius(query_radius, cell_positions[boid_cell_slots[index]], index, std::forward<Visitor>(visitor));
 }
 
-template <typename ObjType>
-Eigen::Vector2i SpatialGrid<ObjType>::GetIndex(Eigen::Vector2f position) {
-
-    float cX = (position.x()) / (world_dimensions.x() * 2);
-    float cY = (position.y()) / (world_dimensions.y() * 2);
-
-    int xIndex = static_cast<int>(std::floor(cX * grid_dimensions.x()));
-    int yIndex = static_cast<int>(std::floor(cY * grid_dimensions.y()));
-
-    return {xIndex, yIndex};
+template<typename Visitor>
+void SpatialGrid::ForEachPosInRadius(float query_radius, Eigen::Vector2f position, Visitor&& visitor) const {
+    ForEachInRadius(query_radius, position, -1, std::forward<Visitor>(visitor));
 }
 
-template <typename ObjType>
-void SpatialGrid<ObjType>::DrawGrid(sf::RenderWindow* window) {
-    if (is_visible) {
-        for (int r = 0; r < grid_dimensions.y(); ++r) {
-            for (int c = 0; c < grid_dimensions.x(); ++c) {
-                int key = CreateKeyFromIndex(c, r);
-                if (int num_boids = grid[key].size(); num_boids > 0) {
-                    // Calculate grayscale color value based on number of obj
-                    int grayscale_value = std::min(num_boids * 10, 255);
-
-                    sf::RectangleShape rect(sf::Vector2f(cell_size, cell_size));
-                    rect.setPosition(c * cell_size, r * cell_size);
-                    rect.setFillColor(sf::Color::Transparent);
-
-                    // Set outline color based on grayscale value
-                    rect.setOutlineColor(sf::Color(grayscale_value, grayscale_value, grayscale_value));
-                    rect.setOutlineThickness(3);
-                    window->draw(rect);
-
+template<typename CellCount, typename BoidCount>
+int SpatialGrid::CountObjInRadius(float query_radius, int index, CellCount&& cell_count, BoidCount&& boid_count) const {
+    Eigen::Vector2f position = cell_positions[boid_cell_slots[index]];
+    float squared_query_radius = query_radius * query_radius;
+    // Whole cells are only counted when their far corner is safely inside the radius, so rounding in the per-boid
+    // distances cannot make the result differ from a boid by boid search.
+    float squared_inner_radius = squared_query_radius * 0.999f;
+
+    int count = 0;
+    int first_row = GetRow(position.y() - query_radius);
+    int last_row = GetRow(position.y() + query_radius);
+    for (int row = first_row; row <= last_row; ++row) {
+        // Same row and column bounds as ForEachInRadius
+        bool border_row = row == 0 || row == grid_dimensions.y() - 1;
+        float row_top = row == 0 ? -std::numeric_limits<float>::infinity() : static_cast<float>(row * cell_size);
+        float row_bottom = row == grid_dimensions.y() - 1 ? std::numeric_limits<float>::infinity() : static_cast<float>((row + 1) * cell_size);
+        float d_y = std::max({0.f, row_top - position.y(), position.y() - row_bottom});
+        if (d_y > query_radius) continue;
+
+        float half_width = std::sqrt(squared_query_radius - d_y * d_y);
+        int first_column = GetColumn(position.x() - half_width);
+        int last_column = GetColumn(position.x() + half_width);
+        for (int column = first_column; column <= last_column; ++column) {
+            int key = CreateKeyFromIndex(column, row);
+
+            // Border cells also hold the boids outside the world, so they are never completely inside
+            bool border_cell = border_row || column == 0 || column == grid_dimensions.x() - 1;
+            if (!border_cell) {
+                float far_x = std::max(std::abs(position.x() - static_cast<float>(column * cell_size)),
+                                       std::abs(position.x() - static_cast<float>((column + 1) * cell_size)));
+                float far_y = std::max(std::abs(position.y() - row_top), std::abs(position.y() - row_bottom));
+                if (far_x * far_x + far_y * far_y < squared_inner_radius) {
+                    count += cell_count(key);
+                    if (boid_keys[index] == key) count -= boid_count(index);
+                    continue;
                 }
             }
-        }
-    }
-}
-
-template<typename ObjType>
-void SpatialGrid<ObjType>::AddObj(const std::shared_ptr<ObjType>& obj) {
-    auto index = GetIndex(obj->pos);
-    int key = CreateKeyFromIndex(index.x(), index.y());
-
-    grid[key].insert(obj);
-    obj->spatial_key = key;
-}
-
-template<typename ObjType>
-void SpatialGrid<ObjType>::UpdateObj(const std::shared_ptr<ObjType>& obj) {
-    auto index = GetIndex(obj->pos);
-    int key = CreateKeyFromIndex(index.x(), index.y());
-
-    if(key != obj->spatial_key) {
-        RemoveObj(obj);
-        grid[key].insert(obj); // creates a copy of shared_ptr, assigning an additional owner (grid)
-        obj->spatial_key = key;
-    }
-}
-
-template<typename ObjType>
-void SpatialGrid<ObjType>::RemoveObj(const std::shared_ptr<ObjType>& obj) {
-    grid[obj->spatial_key].erase(obj);
-}
-
-template<typename ObjType>
-std::vector<ObjType*> SpatialGrid<ObjType>::ObjRadiusSearch(float query_radius, const std::shared_ptr<ObjType>& obj) const {
-
-    std::vector<ObjType*> obj_in_radius;
-
-    double d = query_radius / static_cast<double>(cell_size); // convert radius in pixel space to grid space
-    int d2 = std::floor(d*d);
-    if (d2 > max_d2) d2 = max_d2;
 
-    float squared_query_radius = query_radius * query_radius;
-
-    int obj_cell_key = obj->spatial_key;
-    for(int i = 0; i < num_offsets_within_distance.at(d2); i++) {
-        // Get neighbouring cell's key by adding the appropriate offset to the cell_key of the querying object
-        int key = obj_cell_key + global_offset.at(i);
-
-        // Check if neighbour cell is within the grid bounds, if not disregard it and continue.
-        if (key < 0 || key > max_possible_key) continue;
-
-        // Check objects within the neighbour cell
-        // std::cout << "\nboid key: " << key << std::endl;
-        // for (auto pair : grid) {
-        //    std::cout << "map key: " << pair.first << std::endl;
-        // }
-        for(const auto& other_obj : grid.at(key)) {
-            if(other_obj.get() == obj.get()) continue;
-
-            Eigen::Vector2f difference = (obj->pos - other_obj->pos);
-            float squared_distance = difference.squaredNorm();
-            if (squared_distance <= squared_query_radius) {
-                obj_in_radius.push_back(other_obj.get());
+            for (int slot = cell_start[key]; slot < cell_start[key + 1]; ++slot) {
+                if (cell_boids[slot] == index) continue;
+                if ((position - cell_positions[slot]).squaredNorm() <= squared_query_radius) {
+                    count += boid_count(cell_boids[slot]);
+                }
             }
         }
     }
-    return obj_in_radius;
-}
-
-template<typename ObjType>
-std::vector<ObjType*> SpatialGrid<ObjType>::PosRadiusSearch(float query_radius, Eigen::Vector2f position) {
-
-    std::vector<ObjType*> obj_in_radius;
-
-    double d = query_radius / static_cast<double>(cell_size); // convert radius in world space to grid space
-    int d2 = std::floor(d*d);
-    if (d2 > max_d2) d2 = max_d2;
-
-    Eigen::Vector2i index = GetIndex(std::move(position));
-    int key_of_position = CreateKeyFromIndex(index.x(), index.y());
-
-    for(int i = 0; i < num_offsets_within_distance[d2]; i++) {
-
-        // Get neighbouring cell's key by adding the appropriate offset to the cell_key of the querying object
-        int key = key_of_position + global_offset[i];
-
-        // Check if neighbour cell is within the grid bounds, if not disregard it and continue.
-        if (key < 0 || key > max_possible_key) continue;
-
-        // Check objects within the neighbour cell
-        for(const auto& other_obj : grid[key]) {
-            Eigen::Vector2f difference = (position - other_obj->pos);
-            float squared_distance = difference.squaredNorm();
-            if (squared_distance <= query_radius * query_radius) obj_in_radius.push_back(other_obj.get());
-        }
-    }
-    return obj_in_radius;
-}
-
-template <typename ObjType>
-std::vector<ObjType*> SpatialGrid<ObjType>::LocalSearch(Eigen::Vector2f position) {
-
-    std::vector<ObjType*> objects_in_cell;
-
-    Eigen::Vector2i index = GetIndex(std::move(position));
-    int key_of_point = CreateKeyFromIndex(index.x(), index.y());
-    for(int i = 0; i < num_offsets_within_distance[0]; i++) {
-        int key = key_of_point + global_offset[i];
-        key = std::min<int>(std::max(0, key), max_possible_key);
-
-        // Check boids within candidate cells
-        for(const auto& obj : grid[key]) {
-            objects_in_cell.push_back(obj.get());
-        }
-    }
-
-    return objects_in_cell;
-}
-
-template <typename ObjType>
-void SpatialGrid<ObjType>::Clear() {
-    grid.clear();
+    return count;
 }
 
-#endif //SPATIALGRID_TPP
\ No newline at end of file
+#endif //SPATIALGRID_TPP
@@ -0,0 +1,347 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "SweepRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include "MainMenu.h"
+#include "Serialization.h"
+#include "Simulator.h"
+#include "Utility.h"
+
+namespace {
+    // Whole token must be a number (std::stod would throw or accept trailing garbage)
+    std::optional<double> ParseNumber(const std::string &token) {
+        std::istringstream iss(token);
+        double value;
+        if (!(iss >> value) || !(iss >> std::ws).eof()) return std::nullopt;
+        return value;
+    }
+
+    bool EndsWithNewline(const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open() || file.tellg() == 0) return true;
+        file.seekg(-1, std::ios::end);
+        return file.get() == '\n';
+    }
+}
+
+SweepRunner::SweepRunner(std::string scenario_file, std::string sweep_file)
+    : scenario_file(std::move(scenario_file)), sweep_file(std::move(sweep_file)), context(std::make_shared<Context>(true)) {
+    simulation_name = std::filesystem::path(this->scenario_file).stem().string();
+    output_file_path = "output/" + simulation_name + "_sweep.csv";
+}
+
+bool SweepRunner::SetConfigField(SimulationConfig &config, const std::string &field, double value) {
+#define CONFIG_FIELD(name) {#name, [](SimulationConfig& c, double v) { c.name = static_cast<decltype(c.name)>(v); }}
+    static const std::map<std::string, std::function<void(SimulationConfig&, double)>> setters = {
+        CONFIG_FIELD(COHESION_FACTOR), CONFIG_FIELD(ALIGNMENT_FACTOR), CONFIG_FIELD(SEPARATION_FACTOR),
+        CONFIG_FIELD(AVOIDANCE_FACTOR), CONFIG_FIELD(MAX_SPEED), CONFIG_FIELD(MIN_SPEED),
+        CONFIG_FIELD(PERCEPTION_RADIUS), CONFIG_FIELD(INTERACTION_RADIUS), CONFIG_FIELD(SEPARATION_RADIUS),
+        CONFIG_FIELD(BOID_COLLISION_RADIUS), CONFIG_FIELD(RESTITUTION_COEFFICIENT),
+        CONFIG_FIELD(ANALYSIS_LOG_INTERVAL), CONFIG_FIELD(POSITION_LOG_INTERVAL),
+        CONFIG_FIELD(a_COEFFICIENT), CONFIG_FIELD(CONVERSION_RATE),
+        CONFIG_FIELD(LANGUAGE_SIZE), CONFIG_FIELD(MUTATION_RATE), CONFIG_FIELD(MIN_INTERACTION_RATE),
+        CONFIG_FIELD(MIN_ADOPTION_RATE), CONFIG_FIELD(BOID_LIFE_STEPS), CONFIG_FIELD(BETA), CONFIG_FIELD(KAPPA),
+        CONFIG_FIELD(TIME_STEPS_PER_RUN), CONFIG_FIELD(RUNS_PER_FRACTION), CONFIG_FIELD(FRACTIONS),
+        CONFIG_FIELD(TOTAL_BOIDS), CONFIG_FIELD(CONFIDENCE_HALF_WIDTH), CONFIG_FIELD(MULTI_THREADING),
+        CONFIG_FIELD(SEED),
+    };
+#undef CONFIG_FIELD
+
+    auto setter = setters.find(field);
+    if (setter == setters.end()) return false;
+    setter->second(config, value);
+    return true;
+}
+
+bool SweepRunner::ValidateConfig(SimulationType type, const SimulationConfig &config) {
+    if (type == EvoSimulation && !config.MULTI_THREADING) {
+        std::cerr << "Error: Evolution Simulator only supported with MULTI_THREADING enabled, for now." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int SweepRunner::Run() {
+    if (!LoadSweepFile()) return EXIT_FAILURE;
+
+    // The scenario type decides the result columns
+    auto loaded_data = serialization::LoadSimulationDataFromFile(scenario_file);
+    if (!loaded_data) {
+        std::cerr << "Error: Something wrong, cannot open file! " << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (loaded_data->type == CompSimulation) {
+        std::set<int> keys;
+        for (auto& spawner : MainMenu::load_key_simulation_data(loaded_data).boid_spawners) {
+            keys.insert(spawner->language_key);
+        }
+        language_keys.assign(keys.begin(), keys.end());
+        result_columns = {"simulated_time", "languages_left"};
+        for (int key : language_keys) result_columns.push_back("boids_language_" + std::to_string(key));
+    } else if (loaded_data->type == EvoSimulation) {
+        result_columns = {"simulated_time", "boids", "distinct_languages"};
+    } else {
+        std::cerr << "Error: Sweeps are only supported for competition and evolution simulations." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Check every job's config up front, instead of failing halfway through the sweep
+    for (const auto& job : ExpandJobs()) {
+        SimulationConfig job_config = *loaded_data->config;
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            SetConfigField(job_config, parameters[i].first, job.values[i]);
+        }
+        if (!ValidateConfig(loaded_data->type, job_config)) return EXIT_FAILURE;
+    }
+
+    // Create the output directory if it doesn't exist
+    if (!std::filesystem::exists("output/"))
+        std::filesystem::create_directory("output/");
+
+    // Resume: skip the jobs that already have a row in the output file
+    std::string header = CreateHeader();
+    std::vector<SweepJob> all_jobs = ExpandJobs();
+    std::set<int> finished_jobs;
+    if (!ReadFinishedJobs(header, all_jobs, finished_jobs)) return EXIT_FAILURE;
+
+    std::vector<SweepJob> jobs;
+    for (auto& job : all_jobs) {
+        if (!finished_jobs.contains(job.id)) jobs.push_back(std::move(job));
+    }
+    std::cout << "Sweep of " << simulation_name << ": " << jobs.size() << " jobs left, "
+              << finished_jobs.size() << " already finished" << std::endl;
+
+    std::ofstream output_file(output_file_path, std::ios::app);
+    if (!output_file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    // Values are written exactly, so ReadFinishedJobs can match a row to its job on resume
+    output_file << std::setprecision(std::numeric_limits<double>::max_digits10);
+    if (finished_jobs.empty() && std::filesystem::file_size(output_file_path) == 0) {
+        output_file << header << std::endl;
+    } else if (!EndsWithNewline(output_file_path)) {
+        // A sweep killed while writing a row, the partial row is ignored (its job runs again)
+        output_file << std::endl;
+    }
+
+    // Every job is a complete single-threaded run, threads keep taking the next job
+    auto start_time = std::chrono::steady_clock::now();
+    int jobs_done = 0;
+    context->thread_pool->Run(static_cast<int>(jobs.size()), [&](int job_nr) {
+        const SweepJob& job = jobs[job_nr];
+        std::optional<std::vector<double>> results = RunJob(job);
+
+        std::lock_guard lock(output_mutex);
+        if (!results) {
+            // Not recorded, so the job runs again when the sweep is resumed
+            std::cerr << "Error: Job " << job.id << " failed" << std::endl;
+            return;
+        }
+        output_file << job.id << ',' << run_time;
+        for (double value : job.values) output_file << ',' << value;
+        for (double value : *results) output_file << ',' << value;
+        output_file << std::endl;   // flushed, so a killed sweep keeps every finished job
+        std::cout << "[" << ++jobs_done << "/" << jobs.size() << "] Job " << job.id << " finished" << std::endl;
+    });
+
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Sweep finished in " << wall_time.count() << "s, results in " << output_file_path << std::endl;
+    return EXIT_SUCCESS;
+}
+
+bool SweepRunner::LoadSweepFile() {
+    std::ifstream file(sweep_file);
+    if (!file.is_open()) {
+        std::cerr << "Error: cannot open sweep file " << sweep_file << std::endl;
+        return false;
+    }
+
+    SimulationConfig test_config;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string prefix;
+        iss >> prefix;
+        if (prefix.empty() || prefix.back() != ':') {
+            std::cerr << "Error: invalid sweep line: " << line << std::endl;
+            return false;
+        }
+        std::string field = prefix.substr(0, prefix.size() - 1);
+
+        if (field == "RUN_TIME") {
+            if (!(iss >> run_time)) {
+                std::cerr << "Error: invalid sweep line: " << line << std::endl;
+                return false;
+            }
+            continue;
+        }
+        if (!SetConfigField(test_config, field, 0)) {
+            std::cerr << "Error: unknown SimulationConfig field: " << field << std::endl;
+            return false;
+        }
+
+        std::vector<double> values;
+        std::string token;
+        while (iss >> token) {
+            // Range: start:stop:step
+            if (std::ranges::count(token, ':') == 2) {
+                std::replace(token.begin(), token.end(), ':', ' ');
+                double start, stop, step;
+                std::istringstream range(token);
+                if (!(range >> start >> stop >> step) || !(range >> std::ws).eof()) {
+                    std::cerr << "Error: invalid range in sweep line: " << line << std::endl;
+                    return false;
+                }
+                if (step <= 0) {
+                    std::cerr << "Error: range step must be positive: " << line << std::endl;
+                    return false;
+                }
+                int steps = static_cast<int>(std::floor((stop - start) / step + 1e-6));
+                for (int i = 0; i <= steps; ++i) values.push_back(start + i * step);
+            } else {
+                auto value = ParseNumber(token);
+                if (!value) {
+                    std::cerr << "Error: invalid value '" << token << "' in sweep line: " << line << std::endl;
+                    return false;
+                }
+                values.push_back(*value);
+            }
+        }
+        if (values.empty()) {
+            std::cerr << "Error: no values for " << field << std::endl;
+            return false;
+        }
+        parameters.emplace_back(field, values);
+    }
+
+    if (run_time <= 0) {
+        std::cerr << "Error: the sweep file needs a RUN_TIME (simulated seconds per job)." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<SweepRunner::SweepJob> SweepRunner::ExpandJobs() const {
+    // Cartesian product of all value lists, the last field changes fastest
+    std::vector<SweepJob> jobs = {{0, {}}};
+    for (const auto& [field, values] : parameters) {
+        std::vector<SweepJob> expanded_jobs;
+        for (const auto& job : jobs) {
+            for (double value : values) {
+                SweepJob expanded_job = job;
+                expanded_job.values.push_back(value);
+                expanded_jobs.push_back(std::move(expanded_job));
+            }
+        }
+        jobs = std::move(expanded_jobs);
+    }
+    for (size_t i = 0; i < jobs.size(); ++i) jobs[i].id = static_cast<int>(i);
+    return jobs;
+}
+
+std::string SweepRunner::CreateHeader() const {
+    std::string header = "job,RUN_TIME";
+    for (const auto& [field, values] : parameters) header += "," + field;
+    for (const auto& column : result_columns) header += "," + column;
+    return header;
+}
+
+bool SweepRunner::ReadFinishedJobs(const std::string &header, const std::vector<SweepJob> &jobs, std::set<int> &finished_jobs) const {
+    std::ifstream file(output_file_path);
+    if (!file.is_open()) return true;
+
+    std::string line;
+    if (!std::getline(file, line)) return true;
+    if (line != header) {
+        std::cerr << "Error: " << output_file_path << " belongs to a different sweep, move it to start a new one." << std::endl;
+        return false;
+    }
+    // Only complete rows count as finished, a row cut off by a killed sweep is skipped. A complete row must have the
+    // run time and parameter values of its job, otherwise the sweep file changed and the row is a stale result.
+    size_t num_columns = std::ranges::count(header, ',') + 1;
+    while (std::getline(file, line)) {
+        std::istringstream row(line);
+        std::string cell;
+        std::vector<double> cells;
+        while (std::getline(row, cell, ',')) {
+            auto value = ParseNumber(cell);
+            if (!value) break;
+            cells.push_back(*value);
+        }
+        if (cells.size() != num_columns) continue;
+
+        int job_id = static_cast<int>(cells[0]);
+        bool matches = cells[0] == job_id && job_id >= 0 && job_id < static_cast<int>(jobs.size()) &&
+                       cells[1] == static_cast<double>(run_time) &&
+                       std::equal(jobs[job_id].values.begin(), jobs[job_id].values.end(), cells.begin() + 2);
+        if (!matches) {
+            std::cerr << "Error: " << output_file_path << " has results of a different sweep (row: " << line
+                      << "), move it to start a new one." << std::endl;
+            return false;
+        }
+        finished_jobs.insert(job_id);
+    }
+    return true;
+}
+
+std::optional<std::vector<double>> SweepRunner::RunJob(const SweepJob &job) const {
+    // Every job loads its own copy of the scenario, simulators modify their terrains and spawners
+    auto loaded_data = serialization::LoadSimulationDataFromFile(scenario_file);
+    if (!loaded_data) return std::nullopt;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        SetConfigField(*loaded_data->config, parameters[i].first, job.values[i]);
+    }
+    if (!ValidateConfig(loaded_data->type, *loaded_data->config)) return std::nullopt;
+
+    // A single thread per job, the jobs themselves are the parallel work
+    auto job_context = std::make_shared<Context>(true, 1);
+    std::string job_name = simulation_name + "_sweep_" + std::to_string(job.id);
+    const sf::Time time_step = sf::seconds(Simulator::FIXED_TIME_STEP);
+
+    if (loaded_data->type == CompSimulation) {
+        // The analyser's logs are only written by the interactive simulator, a job would keep them in memory for nothing
+        loaded_data->config->ANALYSIS_LOG_INTERVAL = 0;
+        KeySimulationData simulation_data = MainMenu::load_key_simulation_data(loaded_data);
+        CompSimulator simulation(job_context, simulation_data, job_name, 1600, 900);
+        simulation.Init();
+
+        std::map<int, int> boids_per_language;
+        while (true) {
+            boids_per_language.clear();
+            for (int language_key : simulation.boids.language_key) boids_per_language[language_key]++;
+            if (simulation.total_simulation_time >= run_time || boids_per_language.size() <= 1) break;
+            simulation.Step(time_step);
+        }
+
+        std::vector<double> results = {simulation.total_simulation_time, static_cast<double>(boids_per_language.size())};
+        for (int key : language_keys) results.push_back(boids_per_language[key]);
+        return results;
+    }
+
+    VectorSimulationData simulation_data = MainMenu::load_vector_simulation_data(loaded_data);
+    EvoSimulator simulation(job_context, simulation_data, job_name, 1600, 900);
+    simulation.Init();
+    while (simulation.total_simulation_time < run_time) {
+        simulation.Step(time_step);
+    }
+
+    int num_languages = simulation.boids.GetLanguageTable().NumLanguages();
+    return std::vector<double>{simulation.total_simulation_time, static_cast<double>(simulation.boids.Size()), static_cast<double>(num_languages)};
+}
@@ -0,0 +1,66 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Application.h"
+#include "SimulationConfig.h"
+#include "SimulationData.h"
+
+// Runs a scenario headless for every combination of SimulationConfig values in a sweep file. Jobs run in parallel
+// (one job per thread) and every finished job is appended as a row to "output/<scenario>_sweep.csv". Jobs already in
+// that file with the same run time and parameter values are skipped, so an interrupted sweep continues where it stopped.
+//
+// Usage: Thesis_run --sweep <scenario file> <sweep file>
+// Sweep file, one line per swept field (field names as in SimulationConfig):
+//     RUN_TIME: 300                 simulated seconds per job
+//     a_COEFFICIENT: 1.0:2.0:0.25   range start:stop:step (stop included)
+//     BETA: 1 5 10                  list of values
+class SweepRunner {
+public:
+    SweepRunner(std::string scenario_file, std::string sweep_file);
+
+    // Returns the process exit code.
+    int Run();
+
+    static bool SetConfigField(SimulationConfig& config, const std::string& field, double value);
+    // Same checks as HeadlessRunner, prints the reason when a config cannot be run
+    static bool ValidateConfig(SimulationType type, const SimulationConfig& config);
+
+private:
+    struct SweepJob {
+        int id;
+        std::vector<double> values;     // one value per swept field
+    };
+
+    std::string scenario_file;
+    std::string sweep_file;
+    std::string simulation_name;
+    std::string output_file_path;
+    std::shared_ptr<Context> context;
+
+    float run_time = 0;
+    std::vector<std::pair<std::string, std::vector<double>>> parameters;
+    std::vector<std::string> result_columns;
+    std::vector<int> language_keys;     // comp simulations: one result column per language
+
+    std::mutex output_mutex;
+
+    bool LoadSweepFile();
+    std::vector<SweepJob> ExpandJobs() const;
+    std::string CreateHeader() const;
+    bool ReadFinishedJobs(const std::string& header, const std::vector<SweepJob>& jobs, std::set<int>& finished_jobs) const;
+    std::optional<std::vector<double>> RunJob(const SweepJob& job) const;
+};
+
+#endif //SWEEPRUNNER_H
@@ -6,7 +6,7 @@
 
 #include <iostream>
 
-#include "boid.h"
+#include "Boid.h"
 #include <SFML/Graphics/RenderWindow.hpp>
 
 Terrain::Terrain(const std::vector<Eigen::Vector2f>& vertices, float friction_modifier, const std::pair<int, float> &language_status_modifier, float min_speed, float max_speed)
@@ -33,14 +33,14 @@ bool Terrain::IsPointInside(const Eigen::Vector2f &point) const {
     return inside;
 }
 
-void Terrain::ApplyMovementEffects(Boid *boid) const {
-    Eigen::Vector2f acceleration = -boid->vel.normalized() * friction_modifier * boid->max_speed;
-    boid->SetAcceleration(boid->acc + acceleration);
-    boid->SetMinMaxSpeed(min_speed, max_speed);
+void Terrain::ApplyMovementEffects(BoidStore &boids, int index) const {
+    Eigen::Vector2f acceleration = -boids.vel[index].normalized() * friction_modifier * boids.max_speed[index];
+    boids.SetAcceleration(index, boids.acc[index] + acceleration);
+    boids.SetMinMaxSpeed(index, min_speed, max_speed);
 }
 
-void Terrain::ApplyLanguageStatusEffects(CompBoid *boid) const {
-    boid->SetLanguageStatusMap(language_status_map);
+void Terrain::ApplyLanguageStatusEffects(CompBoidStore &boids, int index) const {
+    boids.SetLanguageStatusMap(index, language_status_map.get());
 }
 
 void Terrain::InitLanguageStatusMap(const std::map<int, float> &map) {
@@ -10,9 +10,7 @@
 #include <SFML/Graphics/ConvexShape.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 
-#include "boid.h"
-
-class Boid;
+#include "Boid.h"
 
 class Terrain {
 public:
@@ -21,12 +19,12 @@ public:
 
     bool IsPointInside(const Eigen::Vector2f& point) const;
 
-    void ApplyMovementEffects(Boid *boid) const;
+    void ApplyMovementEffects(BoidStore &boids, int index) const;
     void Draw(sf::RenderWindow* window) const;
 
     std::string ToString() const;
 
-    void ApplyLanguageStatusEffects(CompBoid *boid) const;
+    void ApplyLanguageStatusEffects(CompBoidStore &boids, int index) const;
 
     void InitLanguageStatusMap(const std::map<int, float> &map);
 
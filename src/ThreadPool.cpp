@@ -0,0 +1,97 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    // The calling thread also works on every batch, so one thread less has to be started
+    for (size_t i = 1; i < std::max<size_t>(num_threads, 1); ++i) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mtx);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::Size() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::Run(int num_tasks, const std::function<void(int)> &task) {
+    if (num_tasks <= 0) return;
+
+    // Without workers (or with a single task) there is nothing to hand out
+    if (workers.empty() || num_tasks == 1) {
+        for (int i = 0; i < num_tasks; ++i) task(i);
+        return;
+    }
+
+    // Publish the batch. Workers are all waiting at this point, as the previous batch only returned once every
+    // worker had finished it.
+    {
+        std::lock_guard lock(mtx);
+        current_task = &task;
+        this->num_tasks = num_tasks;
+        next_task = 0;
+        busy_workers = workers.size();
+        batch_nr++;
+    }
+    work_available.notify_all();
+
+    ProcessTasks();
+
+    // Barrier: wait until every worker is done with this batch
+    std::unique_lock lock(mtx);
+    work_done.wait(lock, [this] { return busy_workers == 0; });
+    current_task = nullptr;
+}
+
+void ThreadPool::ParallelFor(int begin, int end, const std::function<void(int, int)> &body) {
+    int num_elements = end - begin;
+    if (num_elements <= 0) return;
+
+    int num_chunks = std::min(static_cast<int>(Size()), num_elements);
+    int elements_per_chunk = num_elements / num_chunks;
+    Run(num_chunks, [&](int chunk) {
+        int start = begin + elements_per_chunk * chunk;
+        int stop = chunk == num_chunks - 1 ? end : start + elements_per_chunk;
+        body(start, stop);
+    });
+}
+
+void ThreadPool::WorkerLoop() {
+    unsigned last_batch_nr = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mtx);
+            work_available.wait(lock, [&] { return stopping || batch_nr != last_batch_nr; });
+            if (stopping) return;
+            last_batch_nr = batch_nr;
+        }
+
+        ProcessTasks();
+
+        std::lock_guard lock(mtx);
+        if (--busy_workers == 0) {
+            work_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::ProcessTasks() {
+    // Threads keep claiming the next unprocessed task until none are left
+    for (int task = next_task++; task < num_tasks; task = next_task++) {
+        (*current_task)(task);
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Long-lived worker threads for the multi-threaded simulation updates. The workers are created once and then sleep
+// until a batch of tasks is submitted, so a simulation step does not have to create and join threads every frame.
+class ThreadPool {
+public:
+    // 'num_threads' is the total amount of threads working on a batch, including the calling thread.
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t Size() const;
+
+    // Runs task(0) .. task(num_tasks - 1) on the pool (the calling thread helps out).
+    // Returns once every task has finished, so it doubles as the barrier between the read and the write phase.
+    void Run(int num_tasks, const std::function<void(int task)> &task);
+
+    // Splits [begin, end) into one contiguous range per thread and calls body(start, end) for each range.
+    void ParallelFor(int begin, int end, const std::function<void(int start, int end)> &body);
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mtx;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    bool stopping = false;
+
+    // Current batch
+    const std::function<void(int)>* current_task = nullptr;
+    int num_tasks = 0;
+    std::atomic<int> next_task = 0;
+    unsigned batch_nr = 0;
+    size_t busy_workers = 0;    // workers that have not finished the current batch yet
+
+    void WorkerLoop();
+    void ProcessTasks();
+};
+
+#endif //THREADPOOL_H
@@ -36,19 +36,87 @@ bool IsKeyPressedOnce(sf::Keyboard::Key keyCode)
 
 
 /*  Random generators */
+RandomGenerator::RandomGenerator(uint64_t seed) {
+    Seed(seed);
+}
+
+void RandomGenerator::Seed(uint64_t seed) {
+    // Expand the seed into the full state with SplitMix64, which never yields an all-zero state
+    for (auto& s : state) {
+        seed += 0x9e3779b97f4a7c15;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        s = z ^ (z >> 31);
+    }
+}
+
+uint64_t RandomGenerator::Next() {
+    auto rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+}
+
+float RandomGenerator::NextFloat() {
+    // Upper 24 bits fill the float mantissa exactly
+    return static_cast<float>(Next() >> 40) * 0x1.0p-24f;
+}
+
+uint32_t RandomGenerator::NextBelow(uint32_t bound) {
+    // Multiply-shift range reduction (bias is negligible for the ranges used here)
+    return static_cast<uint32_t>(((Next() >> 32) * bound) >> 32);
+}
+
+namespace {
+    struct ThreadRandomState {
+        RandomGenerator generator;
+        bool is_seeded = false;
+    };
+    thread_local ThreadRandomState thread_random;
+}
+
+RandomGenerator& GetThreadRandomGenerator() {
+    if (!thread_random.is_seeded) {
+        std::random_device rd;
+        SeedThreadRandomGenerator((static_cast<uint64_t>(rd()) << 32) | rd());
+    }
+    return thread_random.generator;
+}
+
+void SeedThreadRandomGenerator(uint64_t seed) {
+    thread_random.generator.Seed(seed);
+    thread_random.is_seeded = true;
+}
+
+uint64_t CreateStreamSeed(uint64_t seed, uint64_t stream, uint64_t counter) {
+    // Hash the three values together, so neighbouring streams and counters give unrelated seeds
+    RandomGenerator generator(seed);
+    generator.Seed(generator.Next() ^ stream);
+    generator.Seed(generator.Next() ^ counter);
+    return generator.Next();
+}
+
 float GetRandomFloatBetween(float min, float max) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(min, max);
-    return dis(gen);
+    return min + (max - min) * GetThreadRandomGenerator().NextFloat();
 }
 
-/*  Random generators */
 int GetRandomIntBetween(int min, int max) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dis(min, max);
-    return dis(gen);
+    auto range = static_cast<uint32_t>(static_cast<int64_t>(max) - min + 1);
+    return min + static_cast<int>(GetThreadRandomGenerator().NextBelow(range));
+}
+
+void FillRandomFloatsBetween(float min, float max, std::span<float> values) {
+    RandomGenerator& generator = GetThreadRandomGenerator();
+    for (float& value : values) {
+        value = min + (max - min) * generator.NextFloat();
+    }
 }
 
 
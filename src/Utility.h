@@ -4,7 +4,9 @@
 
 #ifndef UTILITY_H
 #define UTILITY_H
+#include <cstdint>
 #include <iostream>
+#include <span>
 #include <string>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Time.hpp>
@@ -16,8 +18,31 @@ class InterfaceManager;
 
 bool IsKeyPressedOnce(sf::Keyboard::Key keyCode);
 
+// Small-state pseudo random generator (xoshiro256**), seeded through SplitMix64.
+class RandomGenerator {
+public:
+    explicit RandomGenerator(uint64_t seed = 0);
+
+    void Seed(uint64_t seed);
+    uint64_t Next();
+    float NextFloat();                  // uniform in [0, 1)
+    uint32_t NextBelow(uint32_t bound); // uniform in [0, bound)
+
+private:
+    uint64_t state[4];
+};
+
+// The random functions below use a generator per thread. Each thread's generator is seeded from std::random_device
+// on first use, unless it was seeded explicitly before.
+RandomGenerator& GetThreadRandomGenerator();
+void SeedThreadRandomGenerator(uint64_t seed);
+
+// Seed for an independent random stream, e.g. one stream per boid per simulation step.
+uint64_t CreateStreamSeed(uint64_t seed, uint64_t stream, uint64_t counter);
+
 float GetRandomFloatBetween(float min, float max);
 int GetRandomIntBetween(int min, int max);
+void FillRandomFloatsBetween(float min, float max, std::span<float> values);
 
 void PrintFPS(sf::Time delta_time);
 
@@ -26,21 +51,4 @@ void DisplayMessage(InterfaceManager interface_manager, sf::Vector2f pos, const
 // Function to calculate the gradient color between green and red based on distance
 sf::Color CalculateGradientColor(float distance);
 
-struct vectorXiHash {
-    std::size_t operator()(const Eigen::VectorXi& v) const {
-        std::size_t seed = 0;
-        for (int i = 0; i < v.size(); ++i) {
-            seed ^= std::hash<int>()(v(i)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
-};
-
-// Comparison function for Eigen::VectorXi
-struct vectorXiEqual {
-    bool operator()(const Eigen::VectorXi& a, const Eigen::VectorXi& b) const {
-        return a.isApprox(b);
-    }
-};
-
 #endif //UTILITY_H
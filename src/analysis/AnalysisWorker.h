@@ -0,0 +1,97 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef ANALYSISWORKER_H
+#define ANALYSISWORKER_H
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Processes snapshots of the simulation state on a separate thread, so metric aggregation and file output do not
+// run inside the simulation step. The simulation thread fills BackBuffer() and calls Submit(), which hands the
+// snapshot to the worker. Up to MAX_PENDING_SNAPSHOTS submitted snapshots can wait to be processed; when the queue
+// is full, Submit() waits for the worker (like TrajectoryWriter::Flush), so no snapshot is ever dropped.
+// The buffers are reused, so their vectors keep their capacity between snapshots.
+template<typename Snapshot>
+class AnalysisWorker {
+public:
+    static constexpr size_t MAX_PENDING_SNAPSHOTS = 4;
+
+    explicit AnalysisWorker(std::function<void(const Snapshot&)> process)
+        : process(std::move(process)), worker_thread(&AnalysisWorker::WorkerLoop, this) {
+    }
+
+    // Processes every submitted snapshot before stopping
+    ~AnalysisWorker() {
+        {
+            std::lock_guard lock(mtx);
+            stopping = true;
+        }
+        snapshot_available.notify_one();
+        worker_thread.join();
+    }
+
+    AnalysisWorker(const AnalysisWorker&) = delete;
+    AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+    Snapshot& BackBuffer() {
+        return buffers[back_index];
+    }
+
+    void Submit() {
+        std::unique_lock lock(mtx);
+        num_submitted++;
+        back_index = (back_index + 1) % buffers.size();
+        snapshot_available.notify_one();
+
+        // The next back buffer must not be waiting to be processed anymore
+        space_available.wait(lock, [this] { return num_submitted < buffers.size(); });
+    }
+
+    // Waits until every submitted snapshot has been processed, e.g. before saving the aggregated metrics
+    void WaitIdle() {
+        std::unique_lock lock(mtx);
+        space_available.wait(lock, [this] { return num_submitted == 0; });
+    }
+
+private:
+    std::function<void(const Snapshot&)> process;
+
+    // Ring of buffers: the 'num_submitted' buffers from 'front_index' on are queued (the first one may be in
+    // processing), the buffer at 'back_index' (right after them) is being filled by the simulation thread.
+    std::array<Snapshot, MAX_PENDING_SNAPSHOTS + 1> buffers;
+    size_t front_index = 0;
+    size_t back_index = 0;          // only changed by the simulation thread
+    size_t num_submitted = 0;
+
+    std::mutex mtx;
+    std::condition_variable snapshot_available;
+    std::condition_variable space_available;    // a snapshot was processed
+    bool stopping = false;
+
+    std::thread worker_thread;
+
+    void WorkerLoop() {
+        std::unique_lock lock(mtx);
+        while (true) {
+            snapshot_available.wait(lock, [this] { return stopping || num_submitted > 0; });
+            if (num_submitted == 0) return;   // stopping, and nothing left to process
+
+            // The simulation thread does not touch queued buffers, so the snapshot is processed without the lock
+            Snapshot& snapshot = buffers[front_index];
+            lock.unlock();
+            process(snapshot);
+            lock.lock();
+
+            front_index = (front_index + 1) % buffers.size();
+            num_submitted--;
+            space_available.notify_all();
+        }
+    }
+};
+
+#endif //ANALYSISWORKER_H
@@ -6,48 +6,63 @@
 #include <iostream>
 #include <fstream>
 
-CompAnalyser::CompAnalyser(std::vector<std::shared_ptr<CompBoid>>& boids)
-: ref_boids(boids) {
+CompAnalyser::CompAnalyser(CompBoidStore& boids)
+: ref_boids(boids), worker([this](const Snapshot& snapshot) { ProcessSnapshot(snapshot); }) {
 }
 
 void CompAnalyser::LogAllMetrics(sf::Time delta_time) {
-    static sf::Time time_since_last_bpl_log;
-    static sf::Time time_since_last_lpc_log;
-
     time_since_last_bpl_log += delta_time;
-    time_since_last_lpc_log += delta_time;
-
-    if (time_since_last_bpl_log >= bpl_time_interval && bpl_time_interval > sf::seconds(0)) {
-        LogBoidsPerLanguage();
-        time_since_last_bpl_log = sf::seconds(0);
-    }
+    time_since_last_ppl_log += delta_time;
+    total_time += delta_time;
+
+    bool log_bpl = time_since_last_bpl_log >= bpl_time_interval && bpl_time_interval > sf::seconds(0);
+    bool log_ppl = time_since_last_ppl_log >= ppl_time_interval && ppl_time_interval > sf::seconds(0);
+    if (!log_bpl && !log_ppl) return;
+    if (log_bpl) time_since_last_bpl_log = sf::seconds(0);
+    if (log_ppl) time_since_last_ppl_log = sf::seconds(0);
+
+    // Only copy the boid state here, the metrics are computed on the analysis thread
+    Snapshot& snapshot = worker.BackBuffer();
+    snapshot.time = total_time.asSeconds();
+    snapshot.log_boids_per_language = log_bpl;
+    snapshot.log_positions = log_ppl;
+    snapshot.language_key = ref_boids.language_key;
+    if (log_ppl) snapshot.pos = ref_boids.pos;
+    worker.Submit();
+}
 
-    if (time_since_last_lpc_log >= ppl_time_interval && ppl_time_interval > sf::seconds(0)) {
-        LogBoidPositions();
-        time_since_last_lpc_log = sf::seconds(0);
-    }
+void CompAnalyser::ProcessSnapshot(const Snapshot &snapshot) {
+    if (snapshot.log_boids_per_language) LogBoidsPerLanguage(snapshot);
+    if (snapshot.log_positions) LogBoidPositions(snapshot);
 }
 
-void CompAnalyser::LogBoidsPerLanguage() {
+void CompAnalyser::LogBoidsPerLanguage(const Snapshot& snapshot) {
     auto map = std::map<int, int>();
-    for (auto& boid : ref_boids) {
-        map[boid->language_key] += 1;
+    for (int language_key : snapshot.language_key) {
+        map[language_key] += 1;
     }
     boids_per_language.push_back(std::move(map));
+    boids_per_language_time.push_back(snapshot.time);
     std::cout << "Language logging complete! (Press F5 to save to output file)" << std::endl;
 }
 
-void CompAnalyser::LogBoidPositions() {
+void CompAnalyser::LogBoidPositions(const Snapshot& snapshot) {
+    if (trajectory_writer) {
+        trajectory_writer->WriteFrame(snapshot.time, snapshot.pos, snapshot.language_key);
+        return;
+    }
+
     std::map<int, std::vector<Eigen::Vector2i>> map;
-    for (auto& boid : ref_boids) {
-        Eigen::Vector2i pos = boid->pos.cast<int>();
-        map[boid->language_key].push_back(pos);
+    for (size_t i = 0; i < snapshot.pos.size(); ++i) {
+        Eigen::Vector2i pos = snapshot.pos[i].cast<int>();
+        map[snapshot.language_key[i]].push_back(pos);
     }
     positions_per_language.push_back(map);
     std::cout << "Position logging logging complete! (Press F5 to save to output file)" << std::endl;
 }
 
 void CompAnalyser::SaveBoidPerLanguageToCSV(const std::string& filename) {
+    worker.WaitIdle();
     if (!boids_per_language.empty()) {
         std::ofstream file(filename);
         if (!file.is_open()) {
@@ -58,12 +73,10 @@ void CompAnalyser::SaveBoidPerLanguageToCSV(const std::string& filename) {
         // CSV Header
         file << "Time Interval: " << static_cast<int>(bpl_time_interval.asSeconds()) << ", Languages: " << boids_per_language[0].size() << " ,Boids \n";
 
-        int timestep = 0;
-        for (const auto& map : boids_per_language) {
-            for (const auto& [language_key, boids] : map) {
-                file << static_cast<int>(timestep * bpl_time_interval.asSeconds()) << "," << language_key << "," << boids << "\n";
+        for (size_t i = 0; i < boids_per_language.size(); ++i) {
+            for (const auto& [language_key, boids] : boids_per_language[i]) {
+                file << static_cast<int>(boids_per_language_time[i]) << "," << language_key << "," << boids << "\n";
             }
-            timestep++;
         }
 
         file.close();
@@ -72,6 +85,13 @@ void CompAnalyser::SaveBoidPerLanguageToCSV(const std::string& filename) {
 }
 
 void CompAnalyser::SavePositionPerLanguageCSV(const std::string& filename) {
+    worker.WaitIdle();
+    // Streamed positions are already on disk
+    if (trajectory_writer) {
+        trajectory_writer->Flush();
+        return;
+    }
+
     if (!positions_per_language.empty()) {
         std::ofstream file(filename);
         if (!file.is_open()) {
@@ -101,6 +121,11 @@ void CompAnalyser::SavePositionPerLanguageCSV(const std::string& filename) {
     }
 }
 
+void CompAnalyser::StreamPositionsTo(const std::string &filename) {
+    worker.WaitIdle();
+    trajectory_writer = std::make_unique<TrajectoryWriter>(filename, 0, ppl_time_interval.asSeconds());
+}
+
 void CompAnalyser::SetBPLTimeInterval(sf::Time interval) {
     bpl_time_interval = interval;
 }
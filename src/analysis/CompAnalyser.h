@@ -7,33 +7,57 @@
 #include <map>
 #include <memory>
 
-#include "../boid.h"
+#include "../Boid.h"
 #include "../LanguageManager.h"
 #include "../World.h"
+#include "AnalysisWorker.h"
+#include "TrajectoryWriter.h"
 
 class CompAnalyser {
 public:
+    // Copy of the boid state taken on the simulation thread, analysed on the analysis thread
+    struct Snapshot {
+        float time = 0;
+        bool log_boids_per_language = false;
+        bool log_positions = false;
+        std::vector<Eigen::Vector2f> pos;
+        std::vector<int> language_key;
+    };
+
     std::vector<std::map<int, int>> boids_per_language;
+    std::vector<float> boids_per_language_time;    // simulation time of each boids_per_language entry
     std::vector<std::map<int, std::vector<Eigen::Vector2i>>> positions_per_language;
 
-    CompAnalyser(std::vector<std::shared_ptr<CompBoid>>& boids);
+    CompAnalyser(CompBoidStore& boids);
     ~CompAnalyser() = default;
 
     void LogAllMetrics(sf::Time delta_time);
-    void LogBoidsPerLanguage();
-    void LogBoidPositions();
+    void LogBoidsPerLanguage(const Snapshot& snapshot);
+    void LogBoidPositions(const Snapshot& snapshot);
 
     void SaveBoidPerLanguageToCSV(const std::string& filename);
     void SavePositionPerLanguageCSV(const std::string &filename);
 
+    // Streams the logged positions to a binary trajectory file instead of keeping them in memory
+    void StreamPositionsTo(const std::string &filename);
+
     void SetBPLTimeInterval(sf::Time interval);
     void SetPPLTimeInterval(sf::Time interval);
 
 private:
-    std::vector<std::shared_ptr<CompBoid>>& ref_boids;
+    CompBoidStore& ref_boids;
+    std::unique_ptr<TrajectoryWriter> trajectory_writer;
 
     sf::Time bpl_time_interval = sf::seconds(1.f);
     sf::Time ppl_time_interval = sf::seconds(1.f);
+    sf::Time time_since_last_bpl_log;
+    sf::Time time_since_last_ppl_log;
+    sf::Time total_time;
+
+    // Declared last: the worker thread stops before the members it uses are destroyed
+    AnalysisWorker<Snapshot> worker;
+
+    void ProcessSnapshot(const Snapshot& snapshot);
 };
 
 #endif //ANALYSER_H
@@ -4,44 +4,38 @@
 
 #include "EvoAnalyser.h"
 
-#include <fstream>
 #include <iostream>
 
-#include "boid.h"
+#include "Boid.h"
 
-EvoAnalyser::EvoAnalyser(std::vector<std::shared_ptr<EvoBoid>> &boids) : ref_boids(boids) {
+EvoAnalyser::EvoAnalyser(EvoBoidStore &boids, const std::string &filename, sf::Time log_time_interval)
+    : ref_boids(boids), log_time_interval(log_time_interval),
+      worker([this](const Snapshot& snapshot) {
+          trajectory_writer->WriteFrame(snapshot.time, snapshot.pos, snapshot.language_words);
+      }) {
+    if (log_time_interval > sf::seconds(0)) {
+        trajectory_writer = std::make_unique<TrajectoryWriter>(filename, boids.config->LANGUAGE_SIZE, log_time_interval.asSeconds());
+    }
 }
 
-void EvoAnalyser::SaveMetricsToCSV(const std::string &filename, sf::Time delta_time) {
-    static sf::Time time_since_lastlog;
-    time_since_lastlog += delta_time;
-
-    if (time_since_lastlog >= log_time_interval && log_time_interval > sf::seconds(0)) {
-        time_since_lastlog = sf::seconds(0);
-
-        // Save Evolution Boid positions and languaeg vector to file
-        std::ofstream file(filename, std::ios_base::app);
-        if (!file.is_open()) {
-            std::cerr << "ERROR: cannot open file " << filename << std::endl;
-            return;
-        }
-        for (auto boid : ref_boids) {
-            file << "(" << boid->pos.x() << ", " << boid->pos.y() << ") ";
-            file << "[";
-            for (size_t i = 0; i < boid->language_vector.size(); ++i) {
-                file << boid->language_vector[i];
-                if (i < boid->language_vector.size() - 1) {
-                    file << ", ";
-                }
-            }
-            file << "]\n";
-        }
-        file << "\n";
-        file.close();
-        std::cout << "Boid data succesfully saved to: " << filename << std::endl;
+void EvoAnalyser::LogMetrics(sf::Time delta_time) {
+    time_since_last_log += delta_time;
+    total_time += delta_time;
+
+    if (time_since_last_log >= log_time_interval && trajectory_writer) {
+        time_since_last_log = sf::seconds(0);
+
+        // Save Evolution Boid positions and language vectors (copying reuses the buffer's memory)
+        Snapshot& snapshot = worker.BackBuffer();
+        snapshot.time = total_time.asSeconds();
+        snapshot.pos = ref_boids.pos;
+        auto language_words = ref_boids.GetLanguageWords();
+        snapshot.language_words.assign(language_words.begin(), language_words.end());
+        worker.Submit();
     }
 }
 
-void EvoAnalyser::SetLogTimeInterval(sf::Time interval) {
-    log_time_interval = interval;
+void EvoAnalyser::Flush() {
+    worker.WaitIdle();
+    if (trajectory_writer) trajectory_writer->Flush();
 }
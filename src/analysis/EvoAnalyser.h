@@ -6,23 +6,40 @@
 #define EVOANALYSER_H
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 #include <Eigen/Dense>
 #include "SFML/System/Time.hpp"
+#include "AnalysisWorker.h"
+#include "TrajectoryWriter.h"
 
-class EvoBoid;
+class EvoBoidStore;
 
 class EvoAnalyser {
 public:
-    EvoAnalyser(std::vector<std::shared_ptr<EvoBoid>>& boids);
+    // Copy of the boid state taken on the simulation thread, written on the analysis thread
+    struct Snapshot {
+        float time = 0;
+        std::vector<Eigen::Vector2f> pos;
+        std::vector<uint64_t> language_words;   // packed language vectors, see EvoBoidStore::GetLanguageWords
+    };
+
+    // Positions and language vectors are streamed to a binary trajectory file (see TrajectoryWriter)
+    EvoAnalyser(EvoBoidStore& boids, const std::string &filename, sf::Time log_time_interval);
     ~EvoAnalyser() = default;
 
-    void SaveMetricsToCSV(const std::string &filename, sf::Time delta_time);
-    void SetLogTimeInterval(sf::Time interval);
+    void LogMetrics(sf::Time delta_time);
+    void Flush();
 
 private:
-    std::vector<std::shared_ptr<EvoBoid>>& ref_boids;
-    sf::Time log_time_interval = sf::seconds(1.f);
+    EvoBoidStore& ref_boids;
+    sf::Time log_time_interval;
+    sf::Time time_since_last_log;
+    sf::Time total_time;
+    std::unique_ptr<TrajectoryWriter> trajectory_writer;
+
+    // Declared last: the worker thread stops before the trajectory writer is destroyed
+    AnalysisWorker<Snapshot> worker;
 };
 
 
@@ -0,0 +1,189 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "TrajectoryReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "TrajectoryWriter.h"
+
+namespace {
+    constexpr size_t FILE_HEADER_SIZE = 4 + sizeof(uint32_t) + sizeof(int32_t) + sizeof(float);
+    constexpr size_t CHUNK_HEADER_SIZE = 2 * sizeof(uint32_t);
+    constexpr size_t FRAME_HEADER_SIZE = sizeof(float) + sizeof(uint32_t);
+
+    // The mapping has no alignment guarantees for the values inside a frame
+    template<typename T>
+    T Load(const char* ptr) {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        return value;
+    }
+}
+
+TrajectoryReader::TrajectoryReader(const std::string &filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "ERROR: cannot open file " << filename << std::endl;
+        return;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    size = static_cast<size_t>(file_size.QuadPart);
+    HANDLE mapping = size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping) data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    file_handle = file;
+    mapping_handle = mapping;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "ERROR: cannot open file " << filename << std::endl;
+        return;
+    }
+    struct stat file_stat{};
+    fstat(fd, &file_stat);
+    size = static_cast<size_t>(file_stat.st_size);
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) data = static_cast<const char*>(mapping);
+    }
+    close(fd);  // the mapping stays valid
+#endif
+
+    if (!data || !IndexFrames()) {
+        std::cerr << "ERROR: not a trajectory file " << filename << std::endl;
+        frames.clear();
+    }
+}
+
+TrajectoryReader::~TrajectoryReader() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping_handle) CloseHandle(mapping_handle);
+    if (file_handle) CloseHandle(file_handle);
+#else
+    if (data) munmap(const_cast<char*>(data), size);
+#endif
+}
+
+bool TrajectoryReader::IndexFrames() {
+    if (size < FILE_HEADER_SIZE || std::memcmp(data, "LBTR", 4) != 0) return false;
+    if (Load<uint32_t>(data + 4) != TrajectoryWriter::VERSION) return false;
+    language_size = Load<int32_t>(data + 8);
+    log_interval = Load<float>(data + 12);
+    if (language_size < 0) return false;
+    const size_t boid_bytes = 2 * sizeof(float) + LanguageBytesPerBoid();
+
+    // Walk the chunks; a chunk that was not completely written (e.g. a run that is still going) is ignored. Indexing
+    // stops at the first chunk whose frames do not exactly fill its payload, as nothing after it can be trusted.
+    size_t offset = FILE_HEADER_SIZE;
+    std::vector<FrameInfo> chunk_frames;
+    while (offset + CHUNK_HEADER_SIZE <= size) {
+        auto payload_bytes = Load<uint32_t>(data + offset);
+        auto num_frames = Load<uint32_t>(data + offset + sizeof(uint32_t));
+        size_t chunk_end = offset + CHUNK_HEADER_SIZE + payload_bytes;
+        if (chunk_end > size) break;
+
+        chunk_frames.clear();
+        size_t frame_offset = offset + CHUNK_HEADER_SIZE;
+        bool consistent = true;
+        for (uint32_t i = 0; i < num_frames; ++i) {
+            if (chunk_end - frame_offset < FRAME_HEADER_SIZE) {
+                consistent = false;
+                break;
+            }
+            float time = Load<float>(data + frame_offset);
+            auto num_boids = Load<uint32_t>(data + frame_offset + sizeof(float));
+            if (num_boids > (chunk_end - frame_offset - FRAME_HEADER_SIZE) / boid_bytes) {
+                consistent = false;
+                break;
+            }
+            chunk_frames.push_back({frame_offset + FRAME_HEADER_SIZE, time, num_boids});
+            frame_offset += FRAME_HEADER_SIZE + num_boids * boid_bytes;
+        }
+        if (!consistent || frame_offset != chunk_end) break;
+
+        frames.insert(frames.end(), chunk_frames.begin(), chunk_frames.end());
+        offset = chunk_end;
+    }
+    return true;
+}
+
+size_t TrajectoryReader::LanguageBytesPerBoid() const {
+    return language_size == 0 ? sizeof(int32_t) : (language_size + 7) / 8;
+}
+
+bool TrajectoryReader::IsOpen() const {
+    return !frames.empty();
+}
+
+int TrajectoryReader::NumFrames() const {
+    return static_cast<int>(frames.size());
+}
+
+int TrajectoryReader::LanguageSize() const {
+    return language_size;
+}
+
+float TrajectoryReader::LogInterval() const {
+    return log_interval;
+}
+
+float TrajectoryReader::FrameTime(int frame) const {
+    return frames[frame].time;
+}
+
+int TrajectoryReader::FrameBoids(int frame) const {
+    return static_cast<int>(frames[frame].num_boids);
+}
+
+void TrajectoryReader::ReadPositions(int frame, std::vector<Eigen::Vector2f> &positions) const {
+    const FrameInfo& info = frames[frame];
+    positions.resize(info.num_boids);
+    const char* ptr = data + info.offset;
+    for (auto& position : positions) {
+        position = {Load<float>(ptr), Load<float>(ptr + sizeof(float))};
+        ptr += 2 * sizeof(float);
+    }
+}
+
+void TrajectoryReader::ReadLanguageKeys(int frame, std::vector<int> &language_keys) const {
+    const FrameInfo& info = frames[frame];
+    language_keys.resize(info.num_boids);
+    const char* ptr = data + info.offset + info.num_boids * 2 * sizeof(float);
+    for (auto& language_key : language_keys) {
+        language_key = Load<int32_t>(ptr);
+        ptr += sizeof(int32_t);
+    }
+}
+
+void TrajectoryReader::ReadLanguageVectors(int frame, std::vector<Eigen::VectorXi> &language_vectors) const {
+    const FrameInfo& info = frames[frame];
+    language_vectors.resize(info.num_boids);
+    const auto* ptr = reinterpret_cast<const uint8_t*>(data + info.offset + info.num_boids * 2 * sizeof(float));
+    for (auto& language_vector : language_vectors) {
+        language_vector.resize(language_size);
+        for (int feature = 0; feature < language_size; ++feature) {
+            language_vector[feature] = (ptr[feature / 8] >> (feature % 8)) & 1;
+        }
+        ptr += LanguageBytesPerBoid();
+    }
+}
+
+int TrajectoryReader::FindFrame(float time) const {
+    auto it = std::upper_bound(frames.begin(), frames.end(), time, [](float t, const FrameInfo& info) { return t < info.time; });
+    return std::max(static_cast<int>(it - frames.begin()) - 1, 0);
+}
@@ -0,0 +1,61 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+// Read-only memory mapping of a trajectory file written by TrajectoryWriter. Opening only indexes the frames, frame
+// data is read straight from the mapping when a frame is requested, so seeking to any frame is immediate.
+class TrajectoryReader {
+public:
+    explicit TrajectoryReader(const std::string &filename);
+    ~TrajectoryReader();
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool IsOpen() const;
+    int NumFrames() const;
+    int LanguageSize() const;   // 0 for language key trajectories
+    float LogInterval() const;
+
+    float FrameTime(int frame) const;
+    int FrameBoids(int frame) const;
+    void ReadPositions(int frame, std::vector<Eigen::Vector2f> &positions) const;
+    void ReadLanguageKeys(int frame, std::vector<int> &language_keys) const;
+    void ReadLanguageVectors(int frame, std::vector<Eigen::VectorXi> &language_vectors) const;
+
+    // Last frame with a time at or before 'time'
+    int FindFrame(float time) const;
+
+private:
+    struct FrameInfo {
+        size_t offset;      // of the frame's position data
+        float time;
+        uint32_t num_boids;
+    };
+
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+    int language_size = 0;
+    float log_interval = 0;
+    std::vector<FrameInfo> frames;
+
+    size_t LanguageBytesPerBoid() const;
+    bool IndexFrames();
+};
+
+#endif //TRAJECTORYREADER_H
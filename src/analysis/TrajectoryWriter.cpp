@@ -0,0 +1,129 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#include "TrajectoryWriter.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+    constexpr size_t CHUNK_HEADER_SIZE = 2 * sizeof(uint32_t);
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::string &filename, int language_size, float log_interval)
+    : file(filename, std::ios::binary), language_size(language_size) {
+    if (!file.is_open()) {
+        std::cerr << "ERROR: cannot open file " << filename << std::endl;
+        return;
+    }
+
+    file.write("LBTR", 4);
+    file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    int32_t size = language_size;
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char*>(&log_interval), sizeof(log_interval));
+
+    current_chunk.reserve(CHUNK_SIZE);
+    current_chunk.resize(CHUNK_HEADER_SIZE);
+    writer_thread = std::thread(&TrajectoryWriter::WriterLoop, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    if (!writer_thread.joinable()) return;
+    Flush();
+    {
+        std::lock_guard lock(mtx);
+        stopping = true;
+    }
+    chunk_available.notify_one();
+    writer_thread.join();
+}
+
+bool TrajectoryWriter::IsOpen() const {
+    return writer_thread.joinable();
+}
+
+void TrajectoryWriter::WriteFrame(float time, std::span<const Eigen::Vector2f> positions, std::span<const int> language_keys) {
+    if (!IsOpen()) return;
+    BeginFrame(time, positions);
+    for (int language_key : language_keys) {
+        Append<int32_t>(language_key);
+    }
+    EndFrame();
+}
+
+void TrajectoryWriter::WriteFrame(float time, std::span<const Eigen::Vector2f> positions, std::span<const uint64_t> language_words) {
+    if (!IsOpen()) return;
+    BeginFrame(time, positions);
+    // Language features are 0 or 1, eight features per byte (the low bytes of each packed word, unused bits are 0)
+    size_t words_per_boid = (language_size + 63) / 64;
+    for (size_t boid_start = 0; boid_start < language_words.size(); boid_start += words_per_boid) {
+        for (int byte_start = 0; byte_start < language_size; byte_start += 8) {
+            uint64_t word = language_words[boid_start + byte_start / 64];
+            Append(static_cast<uint8_t>(word >> (byte_start % 64)));
+        }
+    }
+    EndFrame();
+}
+
+void TrajectoryWriter::BeginFrame(float time, std::span<const Eigen::Vector2f> positions) {
+    Append(time);
+    Append(static_cast<uint32_t>(positions.size()));
+    for (const auto& position : positions) {
+        Append(position.x());
+        Append(position.y());
+    }
+}
+
+void TrajectoryWriter::EndFrame() {
+    frames_in_chunk++;
+    if (current_chunk.size() >= CHUNK_SIZE) {
+        Flush();
+    }
+}
+
+template<typename T>
+void TrajectoryWriter::Append(const T &value) {
+    size_t offset = current_chunk.size();
+    current_chunk.resize(offset + sizeof(T));
+    std::memcpy(current_chunk.data() + offset, &value, sizeof(T));
+}
+
+void TrajectoryWriter::Flush() {
+    if (!IsOpen() || frames_in_chunk == 0) return;
+
+    // Fill in the chunk header
+    uint32_t header[2] = {static_cast<uint32_t>(current_chunk.size() - CHUNK_HEADER_SIZE), frames_in_chunk};
+    std::memcpy(current_chunk.data(), header, CHUNK_HEADER_SIZE);
+
+    {
+        // Only waits when the disk can not keep up with MAX_PENDING_CHUNKS chunks
+        std::unique_lock lock(mtx);
+        chunk_written.wait(lock, [this] { return pending_chunks.size() < MAX_PENDING_CHUNKS; });
+        pending_chunks.push_back(std::move(current_chunk));
+    }
+    chunk_available.notify_one();
+
+    current_chunk = std::vector<char>();
+    current_chunk.reserve(CHUNK_SIZE);
+    current_chunk.resize(CHUNK_HEADER_SIZE);
+    frames_in_chunk = 0;
+}
+
+void TrajectoryWriter::WriterLoop() {
+    while (true) {
+        std::vector<char> chunk;
+        {
+            std::unique_lock lock(mtx);
+            chunk_available.wait(lock, [this] { return stopping || !pending_chunks.empty(); });
+            if (pending_chunks.empty()) break;  // stopping, and everything has been written
+            chunk = std::move(pending_chunks.front());
+            pending_chunks.pop_front();
+        }
+        chunk_written.notify_one();
+
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        file.flush();
+    }
+}
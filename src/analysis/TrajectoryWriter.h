@@ -0,0 +1,73 @@
+//
+// Created by wouter on 17-10-2026.
+//
+
+#ifndef TRAJECTORYWRITER_H
+#define TRAJECTORYWRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+// Streams boid trajectories to a binary file. Frames are collected into chunks in memory, and full chunks are written
+// by a background thread, so logging does not wait on the disk. At most MAX_PENDING_CHUNKS chunks wait to be written,
+// which keeps memory bounded for long runs.
+//
+// File layout (native byte order):
+//   header:  char[4] "LBTR", uint32 version, int32 language_size, float log_interval
+//   chunk:   uint32 payload_bytes, uint32 num_frames, frames
+//   frame:   float time, uint32 num_boids, float[2 * num_boids] positions (x, y),
+//            language data: int32[num_boids] language keys (language_size = 0),
+//            or per boid the language vector packed into (language_size + 7) / 8 bytes (language_size > 0)
+class TrajectoryWriter {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+    static constexpr size_t MAX_PENDING_CHUNKS = 4;
+
+    TrajectoryWriter(const std::string &filename, int language_size, float log_interval);
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool IsOpen() const;
+
+    // Language key simulations
+    void WriteFrame(float time, std::span<const Eigen::Vector2f> positions, std::span<const int> language_keys);
+    // Language vector simulations, with the packed language vectors of all boids ((language_size + 63) / 64 words each)
+    void WriteFrame(float time, std::span<const Eigen::Vector2f> positions, std::span<const uint64_t> language_words);
+
+    // Hands the frames collected so far to the writer thread
+    void Flush();
+
+private:
+    std::ofstream file;
+    int language_size;
+
+    std::vector<char> current_chunk;
+    uint32_t frames_in_chunk = 0;
+
+    std::mutex mtx;
+    std::condition_variable chunk_available;
+    std::condition_variable chunk_written;
+    std::deque<std::vector<char>> pending_chunks;
+    bool stopping = false;
+    std::thread writer_thread;
+
+    void BeginFrame(float time, std::span<const Eigen::Vector2f> positions);
+    void EndFrame();
+    template<typename T>
+    void Append(const T& value);
+    void WriterLoop();
+};
+
+#endif //TRAJECTORYWRITER_H